@@ -1,7 +1,16 @@
 #pragma once
 
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX                     // keeps Windows.h from defining min() and max() over std::min and std::max
+#endif
 #include <Windows.h>                 // GetStdHandle() and HANDLE
+#else
+typedef void* HANDLE;                // no console handle off Windows, sequences use escape codes
+#endif
 #include <iostream>
 
 /*
@@ -30,11 +39,16 @@
 struct sIntro
 {
     HANDLE hConsole;
+    bool waiting = false;            // the event loop clears this on the first key
 
 
     void RunAnimatedSequence()
     {
+#ifdef _WIN32
         hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+#else
+        hConsole = nullptr;
+#endif
 
         RunPokerTextSequence();
     }
@@ -62,9 +76,8 @@ struct sIntro
 
 
     void RunWaitSequence()
-    {
-        char ch;
-        std::cin >> ch;
+    {   // no blocking read here, the key arrives through the event loop
+        waiting = true;
     }
 
 };
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <deque>
+#include "poker_trace.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX                     // keeps Windows.h from defining min() and max() over std::min and std::max
+#endif
+#include <Windows.h>                 // WaitForSingleObject() on the console input handle
+#include <conio.h>                   // _kbhit() and _getch()
+#else
+#include <termios.h>                 // raw mode
+#include <unistd.h>
+#include <poll.h>
+#include <csignal>                   // the terminal is put back on SIGINT / SIGTERM
+#endif
+
+/*
+    Single threaded event loop for the console game:
+
+        keys     raw, one key at a time, no Enter and no echo
+        timers   fixed table of one shot or repeating callbacks
+        tasks    Post() from any thread, run on the loop thread
+        idle     background work in short slices whenever nothing else is due
+
+    Each key is handled and the frame written before the next key is read, the time
+    from reading a key to the end of its handler is kept so the latency is a number.
+    Sleeping on input and the idle slices are traced (poker_trace.h).
+*/
+
+struct sKeyboard
+{
+    bool closed = false;             // stdin hit end of file (piped input)
+#ifndef _WIN32
+    static inline termios saved = {};            // static, the signal handler restores it
+    bool raw = false;
+    void (*previous_int)(int) = SIG_DFL;
+    void (*previous_term)(int) = SIG_DFL;
+
+
+    static void Restore(int signal)
+    {   // ctrl-c or kill while raw: terminal back first, then the signal's own action
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+    }
+#endif
+
+
+    void Begin()
+    {
+#ifndef _WIN32
+        if (!isatty(STDIN_FILENO)) return;
+        tcgetattr(STDIN_FILENO, &saved);
+        termios mode = saved;
+        mode.c_lflag &= ~(ICANON | ECHO);                    // keep ISIG so ctrl-c still works
+        mode.c_cc[VMIN] = 0;
+        mode.c_cc[VTIME] = 0;
+        previous_int = std::signal(SIGINT, Restore);
+        previous_term = std::signal(SIGTERM, Restore);
+        tcsetattr(STDIN_FILENO, TCSANOW, &mode);
+        raw = true;
+#endif
+    }
+
+
+    void End()
+    {
+#ifndef _WIN32
+        if (!raw) return;
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+        std::signal(SIGINT, previous_int);
+        std::signal(SIGTERM, previous_term);
+        raw = false;
+#endif
+    }
+
+
+    bool Wait(int timeout_ms)
+    {   // true when a key can be read without blocking
+#ifdef _WIN32
+        WaitForSingleObject(GetStdHandle(STD_INPUT_HANDLE), (DWORD)timeout_ms);
+        return _kbhit() != 0;
+#else
+        pollfd fd = { STDIN_FILENO, POLLIN, 0 };
+        return poll(&fd, 1, timeout_ms) > 0;
+#endif
+    }
+
+
+    int Read()
+    {   // next key or -1
+#ifdef _WIN32
+        return _kbhit() ? _getch() : -1;
+#else
+        unsigned char ch;
+        ssize_t n = read(STDIN_FILENO, &ch, 1);
+        if (n == 0) closed = true;
+        return (n == 1) ? ch : -1;
+#endif
+    }
+
+};
+
+
+struct sEventLoop
+{
+    typedef std::chrono::steady_clock clock;
+
+    struct sTimer
+    {
+        clock::time_point due;
+        clock::duration period;                              // zero => one shot
+        std::function<void()> fn;
+        bool active = false;
+    };
+
+    static const int max_timers = 16;
+
+    sKeyboard keyboard;
+    sTimer timers[max_timers];
+    std::mutex task_lock;
+    std::deque<std::function<void()>> tasks;
+    std::function<void(int)> on_key;
+    std::function<bool(clock::time_point)> on_idle;          // work until the deadline, false when nothing is left
+    std::chrono::microseconds idle_slice{ 2000 };            // bounds how long a key can wait behind idle work
+    bool running = false;
+
+    long long keys_handled = 0;
+    double latency_total_ms = 0.0;
+    double latency_max_ms = 0.0;
+
+
+    int AddTimer(std::chrono::milliseconds delay, std::chrono::milliseconds period, std::function<void()> fn)
+    {
+        for (int i = 0; i < max_timers; i++)
+        {
+            if (timers[i].active) continue;
+            timers[i].due = clock::now() + delay;
+            timers[i].period = period;
+            timers[i].fn = std::move(fn);
+            timers[i].active = true;
+            return i;
+        }
+        return -1;
+    }
+
+
+    void Post(std::function<void()> fn)
+    {
+        std::lock_guard<std::mutex> lock(task_lock);
+        tasks.push_back(std::move(fn));
+    }
+
+
+    void Quit() { running = false; }
+
+
+    void Run()
+    {
+        keyboard.Begin();
+        running = true;
+        bool idle_pending = true;
+        while (running)
+        {
+            // sleep until a key, the next timer or straight through when idle work is waiting
+            int timeout_ms = idle_pending ? 0 : 100;
+            clock::time_point now = clock::now();
+            for (const sTimer &t : timers)
+            {
+                if (!t.active) continue;
+                long long ms = std::chrono::ceil<std::chrono::milliseconds>(t.due - now).count();   // rounded up, rounding down woke a ms early and spun
+                if (ms < timeout_ms) timeout_ms = ms < 0 ? 0 : (int)ms;
+            }
+
+            bool key_ready;
+            if (timeout_ms > 0)
+            {   // input wait span only when the loop actually sleeps
+                sTraceScope span(trace_input);
+                key_ready = keyboard.Wait(timeout_ms);
+            }
+            else key_ready = keyboard.Wait(0);
+            if (key_ready)
+            {
+                do
+                {   // poll before every read, piped stdin is not in raw mode and read() would block
+                    int key = keyboard.Read();
+                    if (key < 0) break;
+                    clock::time_point start = clock::now();
+                    if (on_key) on_key(key);
+                    double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+                    latency_total_ms += ms;
+                    if (ms > latency_max_ms) latency_max_ms = ms;
+                    keys_handled++;
+                } while (running && keyboard.Wait(0));
+                if (keyboard.closed) running = false;
+            }
+
+            now = clock::now();
+            for (sTimer &t : timers)
+            {
+                if (!t.active || t.due > now) continue;
+                if (t.period.count() > 0) t.due += t.period;
+                else t.active = false;
+                t.fn();
+            }
+
+            for (;;)
+            {
+                std::function<void()> task;
+                {
+                    std::lock_guard<std::mutex> lock(task_lock);
+                    if (tasks.empty()) break;
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+
+            idle_pending = false;
+            if (running && on_idle)
+            {
+                sTraceScope span(trace_idle);
+                idle_pending = on_idle(clock::now() + idle_slice);
+            }
+        }
+        keyboard.End();
+    }
+
+};
@@ -4,268 +4,563 @@
 #include <string>
 #include <random>           // default random engine
 #include <chrono>           // time count
+#ifdef _WIN32
 #include <io.h>             // console _setmode 
 #include <fcntl.h>          // UTF16 no BOM
+#endif
 #include <bitset>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
 #define _ec(x) "\x1b["#x"m" // console color manipulator
-// https://en.wikipedia.org/wiki/Glossary_of_poker_terms
+#define _cls "\x1b[2J\x1b[H"   // clear console, cursor home
 
 #include "ascii_mover.h"
+#include "poker_round.h"
+#include "poker_display.h"
+#include "poker_multihand.h"
+#include "poker_odds.h"
+#include "poker_equity.h"
+#include "poker_spectator.h"
+#include "poker_shard.h"
+#include "event_loop.h"
 
-std::vector<int> deck_ids = 
-{
- // A,  2,  3,  4,  5,  6,  7,  8,  9, 10,  J,  Q,  K        // 0=>12 modulo(13) value mapping  
-        1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13,   // club grouping
-       14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,   // diamond grouping
-       27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,   // spade grouping
-       40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52,   // heart grouping
-       53, 54, 55                                            // three wildcard jokers
-};
-unsigned deal_index = 0;                                     // sequential iteration (todo: auto bounds wrapping??? ((n) % 52)
-const int max_players = 3;                                   // single deck game (shuffle beginning of each round)
-
-const char* PokerHandName[31] =
-{                                                                
-    "high card", "", "", "",       // 0
-    "one pair", "", "", "",        // 4        (2(2))
-    "two pair", "", "", "",        // 8        (2(4))
-    "three of a kind", "",         // 12       (2(6))
-    "straight",                    // 14        
-    "flush",                       // 15  
-    "full house", "", "", "",      // 16       (2(8))
-    "", "", "", "",                //     
-    "four of a kind", "", "", "",  // 24       (2(12))
-    "five of a kind",              // 28       (2(14))
-    "staight flush",               // 29         
-    "royal straight flush"         // 30        
-};
-
-struct HandInfo
-{
-    int cards[5];                 // actual card ID from the deck
-    int high_card;                // used on zero ranking
-    std::bitset<3> jokers;        // track jokers in hand
-    int rank;                     // used for determining hand strength
-    COORD pos;                    // this players screen position 
-};
-HandInfo dealer_hand  = { 0 };    // top center
-HandInfo player1_hand = { 0 };    // right
-HandInfo player2_hand = { 0 };    // bottom center
-HandInfo player3_hand = { 0 };    // left
+sRound table;                                                // deck, seats and chips for the table
+HandInfo &dealer_hand  = table.hands[seat_dealer];           // top center
+HandInfo &player1_hand = table.hands[seat_player1];          // right
+HandInfo &player2_hand = table.hands[seat_player2];          // bottom center
+HandInfo &player3_hand = table.hands[seat_player3];          // left
+sMultiHand multi;                                            // -hands <n> resolves one deal across n draw hands
+bool multi_hand_mode = false;
+sOdds odds;                                                  // outs for the player's hold selection
+sEquity equity;                                              // player against the dealer's draw for one hold
+sEventLoop loop;                                             // keys, timers and idle work for the interactive game
+sIntro intro;
 
+enum GameState { state_intro, state_play, state_select, state_resolved };
+GameState state = state_intro;
+std::bitset<5> hold;                                         // player's selection while in state_select
+bool odds_shown_ready = false;                               // redraw once the selection's odds arrive
+int equity_hold = -1;                                        // hold the equity was computed for, -1 none
+int equity_wanted = -1;                                      // hold the equity worker was started for
+int equity_job = 0;                                          // bumped per start and deal, a stale result is dropped
+int equity_shown = -1;
 
+const int max_watch_fps = 30;                                // -watch redraw cap
+const int watch_cell_width = 40;                             // two tables across an 80 column console
+const int watch_cell_height = 5;                             // four seat rows, status, gap
+const int watch_top = 3;                                     // console row of the first table, 1 based
+const short watch_seat_x[seat_count] = { 10, 20, 10, 0 };    // dealer top center, player 1 right,
+const short watch_seat_y[seat_count] = { 0, 1, 2, 1 };       // player bottom center, player 3 left
 
-static void Deal()
-{
-    std::random_device rd;
-    std::mt19937 mte(rd());
-   
-    deal_index = 0;
-    for(int i=0; i<7; i++)
-        std::shuffle(deck_ids.begin(), deck_ids.end(), mte);
-
-    for (int i = 0; i < 5; ++i)
+
+
+void DisplayResult()
+{   // after Showdown() and Payout()
+    if (table.winners.count() > 1) std::cout << _ec(33) << "Split pot: " << _ec(37);
+    else std::cout << _ec(33) << "Winner: " << _ec(37);
+    for (int s = 0; s < seat_count; s++)
+        if (table.winners[s]) std::cout << SeatName[s] << "  ";
+    std::cout << "\n";
+    for (int s = 0; s < seat_count; s++)
+        if (table.seated[s]) std::cout << SeatName[s] << " chips: " << table.chips[s] << "\n";
+}
+
+
+void AppendCard(std::wstring &frame, int card)
+{   // same colors and symbols as Display(), padded to four columns
+    if (card < 14) frame += L"" _ec(34);
+    if (card > 13 && card < 27) frame += L"" _ec(31);
+    if (card > 26 && card < 40) frame += L"" _ec(34);
+    if (card > 39 && card < 53) frame += L"" _ec(31);
+    if (card > 52) frame += L"" _ec(32);
+    int val = card % 13;
+    if (card > 52) frame += L"@ ";
+    else if (val == 0)  frame += L"A";
+    else if (val == 10) frame += L"J";
+    else if (val == 11) frame += L"Q";
+    else if (val == 12) frame += L"K";
+    else frame += std::to_wstring(val + 1);
+    if (card < 14) frame += L"\u2667";
+    if (card > 13 && card < 27) frame += L"\u2662";
+    if (card > 26 && card < 40) frame += L"\u2664";
+    if (card > 39 && card < 53) frame += L"\u2661";
+    frame += L"" _ec(37);
+    frame += (val == 9 && card < 53) ? L" " : L"  ";
+}
+
+
+void WriteFrame(const std::wstring &frame)
+{   // one write for the whole frame
+    std::cout.flush();
+#ifdef _WIN32
+    int ret = _setmode(_fileno(stdout), _O_U16TEXT);
+    std::wcout << frame << std::flush;
+    ret = _setmode(_fileno(stdout), _O_TEXT);
+#else
+    static std::string utf8;                                 // utf-8 terminals, symbols are all below 0x10000
+    utf8.clear();
+    for (wchar_t c : frame)
     {
-        player2_hand.cards[i] = deck_ids.at(deal_index++); 
-        dealer_hand.cards[i] = deck_ids.at(deal_index++);
+        if (c < 0x80) utf8 += (char)c;
+        else if (c < 0x800) { utf8 += (char)(0xC0 | (c >> 6)); utf8 += (char)(0x80 | (c & 0x3F)); }
+        else { utf8 += (char)(0xE0 | (c >> 12)); utf8 += (char)(0x80 | ((c >> 6) & 0x3F)); utf8 += (char)(0x80 | (c & 0x3F)); }
     }
+    std::cout << utf8 << std::flush;
+#endif
+}
 
-    player2_hand.high_card = 0;
-    player2_hand.rank = 0;
-    player2_hand.jokers.reset();
-    dealer_hand.high_card = 0;
-    dealer_hand.rank = 0;
-    dealer_hand.jokers.reset();
+
+void DisplayGrid(const sMultiHand &grid)
+{   // whole grid is built first and written with a single call (one frame update)
+    static std::wstring frame;
+    frame.clear();
+    for (int h = 0; h < grid.hand_count; h++)
+    {
+        for (int card : grid.cards[h]) AppendCard(frame, card);
+        if (grid.result[h] > 0)  frame += L"" _ec(32) L"W" _ec(37);
+        if (grid.result[h] == 0) frame += L"" _ec(33) L"P" _ec(37);
+        if (grid.result[h] < 0)  frame += L"" _ec(31) L"L" _ec(37);
+        frame += ((h % 3) == 2 || h == grid.hand_count - 1) ? L"\n" : L"   ";
+    }
+    frame += L"Dealer: ";
+    for (int card : grid.cards[grid.hand_count]) AppendCard(frame, card);
+    frame += L" rank: ";
+    for (const char* c = PokerHandName[grid.rank[grid.hand_count]]; *c; c++) frame += (wchar_t)*c;
+    frame += L"\nwins: " + std::to_wstring(grid.wins) + L"  pushes: " + std::to_wstring(grid.pushes)
+           + L"  losses: " + std::to_wstring(grid.losses) + L"  chips: " + std::to_wstring(table.chips[seat_player2]) + L"\n";
+    WriteFrame(frame);
 }
 
 
-static void RankHand(HandInfo &hand)
-{
-    //   solveable by comparison   |   determine by additional steps                    
-    // ============================|=================================
-    //  nothing       =  0  (0)    |          (high card)
-    //  one pair      =  2  (4)    |
-    //  two pair      =  4  (8)    |
-    //  three of kind =  6  (12)   |
-    //                      (14)   |          (straight)
-    //                      (15)   |            (flush)                        
-    //  full house    =  8  (16)   |
-    //  four of kind  = 12  (24)   |
-    //  five of kind  = 14  (28)   |                                     <---- at least one joker present
-    //                      (29)   |         (straight flush)
-    //                      (30)   |      (royal straight flush)
-
-    hand.high_card = 0;
-    hand.rank = 0;
-    hand.jokers.reset();
-    bool flush_found    = false;
-    bool straight_found = false;
-    bool make_ace_high  = false;
-    
+void DisplayOdds(std::bitset<5> hold)
+{   // hold markers under the cards and the chance of finishing in each rank
+    std::cout << "        ";
+    for (int i = 0; i < 5; i++) std::cout << (hold[i] ? "^^ " : "   ");
+    std::cout << "\n";
+    if (equity_hold == (int)hold.to_ulong())
+        std::cout << "  vs dealer: win " << _ec(33) << (100.0 * equity.Win()) << "%" << _ec(37)
+                  << "  tie " << (100.0 * equity.Tie()) << "%  lose " << (100.0 * equity.Loss()) << "%\n";
+    else
+        std::cout << "  vs dealer: calculating\n";
+    if (!odds.Ready(hold))
+    {
+        const sOdds::sHold &h = odds.hold[hold.to_ulong()];
+        std::cout << "  calculating odds " << (100 * h.counted / h.total) << "%\n";
+        return;
+    }
+    const sOdds::sHold &h = odds.hold[hold.to_ulong()];
+    for (int r = 30; r >= 0; r--)
+    {
+        if (!h.category[r]) continue;
+        std::cout << "  " << _ec(33) << (100.0 * h.category[r] / h.total) << "%" << _ec(37) << "  " << PokerHandName[r] << "\n";
+    }
+}
 
-    // find high card ---------------------------------------------------------------------------
-    for (int i = 0; i < 5; i++)
+
+template <class Policy>
+int RunBatch(long long rounds, unsigned seed, int decks)
+{   // headless: every seat plays the same phases as the interactive game, no console output per round
+    static sShoe shoe;
+    static sPolicyRound<Policy> table;                       // one per policy, the game's own table stays untouched
+    table.Seed(seed);
+    table.seated.set();
+    if (decks > 0)
     {
-        if (hand.cards[i] > 52)
-        {   // handle jokers
-            if (hand.cards[i] > hand.high_card)
-                hand.high_card = hand.cards[i];
-            if (hand.cards[i] == 53) hand.jokers.set(0);
-            if (hand.cards[i] == 54) hand.jokers.set(1);
-            if (hand.cards[i] == 55) hand.jokers.set(2);
-        }
-        else 
-        {   // handle standard deck
-            int a = hand.high_card % 13;
-            int b = hand.cards[i] % 13;
-            if (a == 0) a = 13;
-            if (b == 0) b = 13;
-            if (hand.high_card > 52)
-            {
-                if (hand.cards[i] > hand.high_card)
-                    hand.high_card = hand.cards[i];
-            }
-            else if ((b > a))  hand.high_card = hand.cards[i];
-            else if (b == a)
-            {   // choose the higher suit of this card value
-                if (hand.cards[i] > hand.high_card)
-                    hand.high_card = hand.cards[i];
-            }
-        }
+        shoe.Begin(decks, 0, seed);
+        table.shoe = &shoe;
     }
+    long long category[31] = { 0 };
+    long long wins[seat_count] = { 0 };
 
-    size_t offset = hand.jokers.count();
-    // process rank solvable by comparison -----------------------------------------------------------
-    for (int i = 0; i < 5; i++) 
+    auto start = std::chrono::steady_clock::now();
+    for (long long r = 0; r < rounds; r++)
     {
-        for (int j = 0; j < 5; j++)
+        table.PlayHeadless();
+        for (int s = 0; s < seat_count; s++)
         {
-            if (hand.cards[i] > 52 || hand.cards[j] > 52) continue;
-
-            if (i != j && ((hand.cards[j] % 13) == (hand.cards[i] % 13)))
-                hand.rank++;
+            category[table.hands[s].rank]++;
+            if (table.winners[s]) wins[s]++;
         }
-    }   
-    hand.rank *= 2;                                                            // double result to make room for additional ranks
-    if ((hand.rank > 0) && (offset == 0)) return;                              // early out (can not be straight or flush)
-    // handle jokers
-    if ((hand.rank == 12) && (offset == 1)) { hand.rank = 24; return; }       // three of a kind -> four of a kind
-    if ((hand.rank == 12) && (offset == 2)) { hand.rank = 28; return; }       // three of a kind -> five of a kind
-    if ((hand.rank == 8) && (offset == 1))  { hand.rank = 16; return; }       // two pair -> full house
-    if ((hand.rank == 4) && (offset == 1))  { hand.rank = 12; return; }       // one pair -> three of a kind
-    if ((hand.rank == 4) && (offset == 2))  { hand.rank = 24; return; }       // one pair -> four of a kind
-    if ((hand.rank == 4) && (offset == 3))  { hand.rank = 28; return; }       // one pair -> five of a kind
-   
-    // continue evaluation checking for flush hand ---------------------------------------------------
-    std::bitset<4> suit_bitset;
-    for (int i = 0; i < 5; i++)
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << Policy::name << ": " << rounds << " rounds in " << seconds << "s  (" << (long long)(rounds / (seconds > 0 ? seconds : 1)) << " rounds/s)\n";
+    for (int i = 0; i < 31; i++)
+        if (category[i]) std::cout << "  " << PokerHandName[i] << ": " << category[i] << "\n";
+    for (int s = 0; s < seat_count; s++)
+        std::cout << "  " << SeatName[s] << " wins: " << wins[s] << "  chips: " << table.chips[s] << "\n";
+    if (table.shoe)
+        std::cout << "  shoe: " << shoe.decks << " decks, " << shoe.dealing << " reshuffles, "
+                  << shoe.late_shuffles << " late (dealer had to shuffle)\n";
+    shoe.End();                                              // its worker is traced too, stopped before the trace is written
+    table.shoe = nullptr;
+    return 0;
+}
+
+
+int RunBatch(const char* policy, long long rounds, unsigned seed, int decks)
+{   // the ranking order by name, poker_policy.h
+    if (std::strcmp(policy, sHighPolicy::name) == 0) return RunBatch<sHighPolicy>(rounds, seed, decks);
+    if (std::strcmp(policy, sAceHighPolicy::name) == 0) return RunBatch<sAceHighPolicy>(rounds, seed, decks);
+    if (std::strcmp(policy, sAceLowPolicy::name) == 0) return RunBatch<sAceLowPolicy>(rounds, seed, decks);
+    if (std::strcmp(policy, sDeuceToSevenPolicy::name) == 0) return RunBatch<sDeuceToSevenPolicy>(rounds, seed, decks);
+    if (std::strcmp(policy, sAceToFivePolicy::name) == 0) return RunBatch<sAceToFivePolicy>(rounds, seed, decks);
+    std::cout << "unknown policy " << policy << ", one of: " << sHighPolicy::name << " " << sAceHighPolicy::name << " "
+              << sAceLowPolicy::name << " " << sDeuceToSevenPolicy::name << " " << sAceToFivePolicy::name << "\n";
+    return 1;
+}
+
+
+int RunShards(const char* exe, long long rounds, unsigned seed, int shard_count, int processes, int deadline)
+{   // coordinator: shards of the run on worker processes, merged. same numbers and digest for any split
+    sShardCoordinator coordinator;
+    coordinator.exe = exe;
+    coordinator.deadline_seconds = deadline;
+    coordinator.plan.rounds = rounds;
+    coordinator.plan.seed = seed;
+    sShardResult total;
+    auto start = std::chrono::steady_clock::now();
+    bool done = coordinator.Run(shard_count, processes, total);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!done)
     {
-        if (hand.cards[i] < 14) suit_bitset.set(0);                            // clubs
-        if (hand.cards[i] > 13 && hand.cards[i] < 27) suit_bitset.set(1);     // diamonds
-        if (hand.cards[i] > 26 && hand.cards[i] < 40) suit_bitset.set(2);     // spades
-        if (hand.cards[i] > 39 && hand.cards[i] < 53) suit_bitset.set(3);     // hearts
-    }                                                                           // absolutely no need to test for jokers present
-    if (suit_bitset.count() == 1) flush_found = true;
-    
-    // check for straight ----------------------------------------------------------------------------
-    std::sort(hand.cards, hand.cards + 5, 
-        [](const int& first, const int& second) -> bool
-        {   // keeping connection to deck representation (handle Ace later)
-            if ((first < 53) && (second < 53)) 
-            {   // don't check jokers here
-                return ((first % 13) < (second % 13));
-            }
-            else {
-                // handle joker
-                return first > second; // stack jokers up front in decending order
-            }
+        std::cout << coordinator.error << "\n";
+        return 1;
+    }
+
+    std::cout << total.rounds << " rounds, " << coordinator.shards.size() << " shards of " << coordinator.plan.block_rounds
+              << " round blocks on " << (processes > 0 ? std::to_string(processes) + " processes" : std::string("this process"))
+              << " in " << seconds << "s  (" << (long long)(total.rounds / (seconds > 0 ? seconds : 1)) << " rounds/s), "
+              << coordinator.failures << " attempts repeated\n";
+    for (int i = 0; i < 31; i++)
+        if (total.category[i]) std::cout << "  " << PokerHandName[i] << ": " << total.category[i] << "\n";
+    for (int s = 0; s < seat_count; s++)
+    {   // chips per round and its standard error
+        double n = (double)(total.rounds > 0 ? total.rounds : 1);
+        double ev = (double)total.net[s] / n;
+        double variance = std::max(0.0, (double)total.net_squares[s] / n - ev * ev);
+        std::cout << "  " << SeatName[s] << " wins: " << total.wins[s] << "  splits: " << total.splits[s]
+                  << "  EV: " << ev << " +- " << std::sqrt(variance / n) << " chips/round\n";
+    }
+    std::cout << "  digest: " << std::hex << total.Digest() << std::dec << "\n";
+    return 0;
+}
+
+
+int RunShardWorker(int argc, char* argv[])
+{   // poker -shard <rounds> <seed> <block_rounds> <first_block> <blocks> <shard> <attempt> [deadline], one result line on stdout
+    if (argc < 9) return 2;
+    StartShardWatchdog((argc > 9) ? std::atoi(argv[9]) : 0);
+    sShardPlan plan;
+    plan.rounds = std::atoll(argv[2]);
+    plan.seed = (unsigned)std::strtoul(argv[3], nullptr, 10);
+    plan.block_rounds = std::max(1, std::atoi(argv[4]));
+    long long first_block = std::atoll(argv[5]);
+    long long blocks = std::atoll(argv[6]);
+    const char* fail = std::getenv("POKER_SHARD_FAIL");
+    if (fail && std::atoi(fail) == std::atoi(argv[7]) && std::atoi(argv[8]) == 0) return 3;
+    const char* hang = std::getenv("POKER_SHARD_HANG");
+    if (hang && std::atoi(hang) == std::atoi(argv[7]) && std::atoi(argv[8]) == 0)
+        for (;;) std::this_thread::sleep_for(std::chrono::seconds(1));
+    std::cout << plan.Play(first_block, blocks).Line() << std::flush;
+    return 0;
+}
+
+
+void MoveTo(std::wstring &frame, COORD pos)
+{   // cursor to a 0 based column and row
+    frame += L"\x1b[" + std::to_wstring(pos.Y + 1) + L";" + std::to_wstring(pos.X + 1) + L"H";
+}
+
+
+void DisplayTables(const sTableSnapshot* shown, HandInfo (*seats)[seat_count], int tables, const std::string &header)
+{   // spectator grid, every hand drawn at its HandInfo::pos, no clear so the frame does not flicker
+    static std::wstring frame;
+    frame.clear();
+    frame += L"\x1b[H";
+    for (char c : header) frame += (wchar_t)c;
+    frame += L"\x1b[K";
+    for (int t = 0; t < tables; t++)
+    {
+        if (shown[t].round == 0) continue;                   // nothing published yet
+        for (int s = 0; s < seat_count; s++)
+        {
+            MoveTo(frame, seats[t][s].pos);
+            for (int card : seats[t][s].cards) AppendCard(frame, card);
         }
-    );
-    straight_found = true; //default true for sequential test
-    if ((hand.cards[4] % 13 == 12) && (hand.cards[offset] % 13 == 0))
-    {   // King is present. swap Ace to the back.
-        make_ace_high = true;
-        std::rotate(&hand.cards[offset], &hand.cards[offset] + 1, &hand.cards[5]);
+
+        std::string status = "#" + std::to_string(shown[t].round) + ((shown[t].winners & (shown[t].winners - 1)) ? " split" : "");
+        for (int s = 0; s < seat_count; s++)
+            if (shown[t].winners & (1u << s)) status += std::string(" ") + SeatName[s];
+        int top = 0;
+        for (int s = 0; s < seat_count; s++)
+            if (shown[t].winners & (1u << s)) top = std::max(top, shown[t].rank[s]);
+        status += std::string(": ") + PokerHandName[top];
+        status.resize(watch_cell_width - 2, ' ');
+        COORD at = seats[t][seat_dealer].pos;
+        at.X -= watch_seat_x[seat_dealer];
+        at.Y += 3;
+        MoveTo(frame, at);
+        frame += L"" _ec(33);
+        for (char c : status) frame += (wchar_t)c;
+        frame += L"" _ec(37);
     }
-    int error_count = (int)offset+1;
-    for (size_t i = offset; i < 4; i++)
+    COORD below = { 0, (short)(watch_top - 1 + ((tables + 1) / 2) * watch_cell_height) };
+    MoveTo(frame, below);
+    WriteFrame(frame);
+}
+
+
+int RunWatch(int tables, double seconds, unsigned seed, int fps)
+{   // headless tables on every core, redrawn as a grid at most fps times a second, fps 0 only plays.
+    // the view asks for a snapshot, draws what arrived since the last frame and sleeps to the next one
+    typedef std::chrono::steady_clock clock;
+    static sSpectator spectator;
+    static sTableSnapshot shown[max_spectator_tables];
+    static HandInfo seats[max_spectator_tables][seat_count];
+    fps = std::max(0, std::min(max_watch_fps, fps));
+    spectator.Begin(tables, 0, seed);
+    tables = spectator.table_count;
+    for (int t = 0; t < tables; t++)
     {
-        int a = hand.cards[i] % 13;
-        int b = hand.cards[i + 1] % 13;
-        if (make_ace_high)
+        shown[t] = sTableSnapshot();
+        for (int s = 0; s < seat_count; s++)
         {
-            if (a == 0) a = 13;
-            if (b == 0) b = 13;
+            seats[t][s] = HandInfo();
+            seats[t][s].pos.X = (short)((t % 2) * watch_cell_width + watch_seat_x[s]);
+            seats[t][s].pos.Y = (short)(watch_top - 1 + (t / 2) * watch_cell_height + watch_seat_y[s]);
         }
+    }
 
-        if(b - a != 1)
+    sKeyboard keyboard;
+    keyboard.Begin();
+    clock::time_point start = clock::now();
+    clock::time_point end = (seconds > 0) ? start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(seconds))
+                                          : clock::time_point::max();
+    clock::duration interval = std::chrono::microseconds(1000000 / std::max(1, fps));
+    clock::time_point next = start, last_frame = start;
+    long long frames = 0, stale = 0, last_rounds = 0;
+    if (fps > 0) std::cout << _cls;
+    for (;;)
+    {
+        clock::time_point now = clock::now();
+        if (now >= end) break;
+        if (fps > 0 && now >= next)
         {
-            if (b - a <= error_count)
-            {
-                error_count -= (b - a);
-                continue;
+            sTraceScope span(trace_render);
+            for (int t = 0; t < tables; t++)
+            {   // a torn or missing copy keeps the round already on screen
+                sTableSnapshot copy;
+                if (!spectator.Read(t, copy)) { stale += (shown[t].round != 0); continue; }
+                shown[t] = copy;
+                for (int s = 0; s < seat_count; s++)
+                {
+                    std::copy(copy.cards[s], copy.cards[s] + 5, seats[t][s].cards);
+                    seats[t][s].rank = copy.rank[s];
+                }
             }
-            else
-                straight_found = false;
+            spectator.Request();
+
+            long long rounds = spectator.Rounds();
+            double elapsed = std::chrono::duration<double>(now - last_frame).count();
+            long long rate = (frames > 0 && elapsed > 0) ? (long long)((rounds - last_rounds) / elapsed) : 0;
+            last_rounds = rounds;
+            last_frame = now;
+            DisplayTables(shown, seats, tables, std::to_string(tables) + " tables, " + std::to_string(spectator.workers) + " threads  "
+                          + std::to_string(rate) + " rounds/s  " + std::to_string(fps) + " fps  [q]uit");
+            frames++;
+            next += interval;
+            if (next <= now) next = now + interval;          // a slow frame is dropped, never made up in a burst
         }
+
+        clock::time_point wake = (fps > 0) ? std::min(next, end) : end;
+        long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(wake - clock::now()).count() + 1;
+        ms = std::max(0LL, std::min(ms, 100LL));
+        if (keyboard.closed) std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        else if (keyboard.Wait((int)ms) && keyboard.Read() == 'q') break;
     }
+    spectator.End();
+    keyboard.End();
+
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    long long rounds = spectator.Rounds();
+    std::cout << rounds << " rounds on " << tables << " tables, " << spectator.workers << " threads in " << elapsed << "s  ("
+              << (long long)(rounds / (elapsed > 0 ? elapsed : 1)) << " rounds/s)\n";
+    if (fps > 0) std::cout << "  view: " << frames << " frames at up to " << fps << " fps, " << stale << " table reads kept the last round\n";
+    else std::cout << "  no view, throughput reference\n";
+    return 0;
+}
+
 
-    // final rank determination from gathered information --------------------------------------------
-    if (straight_found && flush_found)                                                
+void Render()
+{   // full frame for the current state, written once per key or update
+    sTraceScope span(trace_render);
+    std::cout << _cls;
+    if (state == state_intro) { std::cout << "press any key\n" << std::flush; return; }
+
+    if (state == state_resolved && multi_hand_mode)
+    {
+        DisplayGrid(multi);
+    }
+    else
+    {
+        std::cout << "Dealer: "; DisplayHand(dealer_hand);
+        std::cout << "Player: "; DisplayHand(player2_hand);
+    }
+    if (state == state_select)
+    {
+        odds_shown_ready = odds.Ready(hold);
+        equity_shown = equity_hold;
+        DisplayOdds(hold);
+        std::cout << "\nToggle hold (" << _ec(33) << "0=>4" << _ec(37) << "), ["
+                  << _ec(33) << "d" << _ec(37) << "]raw, ["
+                  << _ec(33) << "q" << _ec(37) << "]uit ";
+    }
+    else
     {
-        if ((hand.cards[4] % 13 == 0))  hand.rank = 30;                             // royal flush
-        else if ((hand.cards[4] % 13 == 12) && (offset == 1)) hand.rank = 30;       //     |
-        else if ((hand.cards[4] % 13 == 11) && (offset == 2)) hand.rank = 30;       //     |
-        else if ((hand.cards[4] % 13 == 10) && (offset == 3)) hand.rank = 30;       //     V
-        else hand.rank = 29;                                                         // straight flush
+        if (state == state_resolved && !multi_hand_mode) DisplayResult();
+        std::cout << "\n";
+        if (state == state_play) std::cout << "[" << _ec(33) << "d" << _ec(37) << "]raw card(s), ["
+                                                   << _ec(33) << "s" << _ec(37) << "]tand, ";
+        std::cout << "[" << _ec(33) << "r" << _ec(37) << "]eload, ["
+                         << _ec(33) << "q" << _ec(37) << "]uit ";
     }
-    else if (flush_found) hand.rank = 15;                                            // flush
-    else if (straight_found) hand.rank = 14;                                         // straight
-    else if (offset == 1) hand.rank = 4;                                             // (joker) one pair
-    else if (offset == 2) hand.rank = 12;                                            // (jokers) three of kind
-    else if (offset == 3) hand.rank = 24;                                            // (jokers) four of kind
+    std::cout << std::flush;
 }
 
 
-void Display(int card)
-{   // set color
-    if (card < 14) std::cout << _ec(34);
-    if (card > 13 && card < 27) std::cout << _ec(31);
-    if (card > 26 && card < 40) std::cout << _ec(34);
-    if (card > 39 && card < 53) std::cout << _ec(31);
-    if (card > 52) std::cout << _ec(32);
-    // show card value 
-    int val = card % 13;
-    if (card > 52) val = 52 - card; // jokers go negative
-    if (val < 0) std::cout << "@";
-    if (val > 0 && val < 10) std::cout << (val + 1);
-    if (val == 0)  std::cout << "A";
-    if (val == 10) std::cout << "J";
-    if (val == 11) std::cout << "Q";
-    if (val == 12) std::cout << "K";
-    // show card suit symbol
-    int ret = _setmode(_fileno(stdout), _O_U16TEXT);
-    if (card < 14) std::wcout << L"\u2667" << _ec(37) << L" ";
-    if (card > 13 && card < 27) std::wcout << L"\u2662" << _ec(37) << L" ";
-    if (card > 26 && card < 40) std::wcout << L"\u2664" << _ec(37) << L" ";
-    if (card > 39 && card < 53) std::wcout << L"\u2661" << _ec(37) << L" ";
-    if (card > 52) std::wcout << _ec(37) << L"  ";
-    ret = _setmode(_fileno(stdout), _O_TEXT);
+void NewRound()
+{
+    table.Deal();
+    {
+        sTraceScope span(trace_rank);
+        RankHand(dealer_hand);                               // sorted once so the positions stay put on screen
+        RankHand(player2_hand);
+    }
+    odds.Begin(table, seat_player2, false);                  // counted in the loop's idle slices
+    hold.set();
+    odds.Select(hold);
+    equity.Cancel();
+    equity_job++;
+    equity_hold = equity_wanted = -1;
+    state = state_play;
 }
 
 
-void DisplayHand(HandInfo &hand)
+void Resolve()
 {
-    RankHand(hand);
-    for (int card : hand.cards) Display(card);
-    std::cout << "  rank: " << PokerHandName[hand.rank] << "\n";
+    if (multi_hand_mode)
+    {
+        multi.Play(table, seat_player2, hold);
+    }
+    else
+    {   // dealer draws by the house rule, then every seated hand is compared
+        table.Draw(seat_player2, hold);
+        table.DealerDraw();
+        table.Showdown();
+        table.Payout();
+    }
+    state = state_resolved;
 }
 
 
-int main()
+void OnKey(int key)
 {
-    sIntro intro;
-    intro.RunAnimatedSequence();
+    if (key == 'q') { loop.Quit(); return; }
+    switch (state)
+    {
+    case state_intro:
+        intro.waiting = false;
+        NewRound();
+        break;
+    case state_play:
+        if (key == 'r') NewRound();
+        if (key == 'd') state = state_select;                // toggle the cards to keep, the odds panel follows
+        if (key == 's') { hold.set(); Resolve(); }
+        break;
+    case state_select:
+        if (key >= '0' && key <= '4') { hold.flip(key - '0'); odds.Select(hold); }
+        if (key == 'd') Resolve();
+        break;
+    case state_resolved:
+        if (key == 'r') NewRound();
+        break;
+    }
+    Render();
+}
+
+
+int TraceEnd(const char* path, int code)
+{   // writes the -trace file, passes the exit code through
+    if (!path) return code;
+    long long spans = 0, dropped = 0;
+    if (!trace.Write(path, spans, dropped))
+    {
+        std::cout << "can not write trace " << path << "\n";
+        return code ? code : 1;
+    }
+    std::cout << "trace: " << spans << " spans from " << trace.rings << " threads (" << dropped << " overwritten) => " << path << "\n";
+    return code;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // poker -trace <file.json> [mode ...]   (phase spans of any mode below, Chrome trace-event JSON)
+    const char* exe = argv[0];                               // -shards starts its workers from it
+    const char* trace_path = nullptr;
+    if (argc > 2 && std::strcmp(argv[1], "-trace") == 0)
+    {
+        trace_path = argv[2];
+        argc -= 2;
+        argv += 2;
+        trace.Begin();
+        trace.Name("main");
+    }
+
+    // poker -batch <rounds> [seed] [decks] [policy]   (decks 1 => 8 deals from a shoe, 0 a fresh deck every round;
+    //                                                 policy high, ace-high, ace-low, deuce-to-seven or ace-to-five)
+    if (argc > 1 && std::strcmp(argv[1], "-batch") == 0)
+    {
+        long long rounds = (argc > 2) ? std::atoll(argv[2]) : 1000000;
+        unsigned seed = (argc > 3) ? (unsigned)std::strtoul(argv[3], nullptr, 10) : 1;
+        int decks = (argc > 4) ? std::atoi(argv[4]) : 0;
+        const char* policy = (argc > 5) ? argv[5] : sHighPolicy::name;
+        return TraceEnd(trace_path, RunBatch(policy, rounds, seed, decks));
+    }
+    // poker -shards <rounds> [seed] [shards] [processes] [deadline]   (run split over worker processes, processes 0 => in this one,
+    //                                                                 deadline seconds per worker attempt, 0 => from its rounds)
+    if (argc > 1 && std::strcmp(argv[1], "-shards") == 0)
+    {
+        long long rounds = (argc > 2) ? std::atoll(argv[2]) : 1000000;
+        unsigned seed = (argc > 3) ? (unsigned)std::strtoul(argv[3], nullptr, 10) : 1;
+        int shards = (argc > 4) ? std::atoi(argv[4]) : 16;
+        int processes = (argc > 5) ? std::atoi(argv[5]) : (int)std::thread::hardware_concurrency();
+        int deadline = (argc > 6) ? std::atoi(argv[6]) : 0;
+        return TraceEnd(trace_path, RunShards(exe, rounds, seed, shards, processes, deadline));
+    }
+    if (argc > 1 && std::strcmp(argv[1], "-shard") == 0) return RunShardWorker(argc, argv);
+    // poker -watch [tables] [seconds] [seed] [fps]   (spectator grid of headless tables, seconds 0 => until q, fps 0 => no view)
+    if (argc > 1 && std::strcmp(argv[1], "-watch") == 0)
+    {
+        int tables = (argc > 2) ? std::atoi(argv[2]) : 4;
+        double seconds = (argc > 3) ? std::atof(argv[3]) : 10.0;
+        unsigned seed = (argc > 4) ? (unsigned)std::strtoul(argv[4], nullptr, 10) : 1;
+        int fps = (argc > 5) ? std::atoi(argv[5]) : 10;
+        return TraceEnd(trace_path, RunWatch(tables, seconds, seed, fps));
+    }
+    // poker -hands <n>   (multi-hand play, 2 => 100 draw hands per deal)
+    if (argc > 2 && std::strcmp(argv[1], "-hands") == 0)
+    {
+        multi.hand_count = std::max(2, std::min(max_multi_hands, std::atoi(argv[2])));
+        multi_hand_mode = true;
+    }
+
+    {
+        sTraceScope span(trace_intro);
+        intro.RunAnimatedSequence();
+    }
 
     // 80 char width console
     // todo: initialize players screen position
@@ -278,7 +573,6 @@ int main()
     // setup the deck and game
     //unsigned seed = (unsigned)std::chrono::system_clock::now().time_since_epoch().count();
     //std::default_random_engine rng(seed);
-    Deal();
     
     
     /* Debug testing like these values. 
@@ -299,53 +593,36 @@ int main()
     */
 
 
-    std::cout << "Dealer: "; DisplayHand(dealer_hand);
-    std::cout << "Player: "; DisplayHand(player2_hand);
-    
-    // start main loop
-    char ch;
-    int num;
-    bool quit = false;
-    int draw_round = 0;
-    while (!quit)
+    // start main loop: keys drive the game, odds and equity are counted between keys,
+    // a 30Hz tick redraws once the selected odds or equity arrive
+    loop.on_key = OnKey;
+    loop.on_idle = [](sEventLoop::clock::time_point deadline)
     {
-        std::cout << "\n[" << _ec(33) << "d" << _ec(37) << "]raw card(s), [" 
-                           << _ec(33) << "r" << _ec(37) << "]eload, ["
-                           << _ec(33) << "q" << _ec(37) << "]uit ";
-        std::cin >> ch;
-        if (ch == 'r') {
-            system("cls");
-            Deal();
-            std::cout << "Dealer: "; DisplayHand(dealer_hand); 
-            std::cout << "Player: "; DisplayHand(player2_hand);
-            draw_round = 0;
-        }
-        if (ch == 'q') quit = true;
-        if (ch == 'd' && draw_round < 1) {
-            draw_round++;
-            std::cout << "Number of Cards (" << _ec(33) << "1=>5" << _ec(37) << ") ";
-            std::vector<int> card_ids;
-            std::cin >> num;
-            for (int i = 0; i < num; i++)
-            {
-                std::cout << "Which Card (" << _ec(33) << "0=>4" << _ec(37) << ") ";
-                int which;
-                std::cin >> which;
-                card_ids.push_back(which);
-            }
-            // update with new cards, display and continue
-            for (int id : card_ids)
+        if (state == state_select && equity_wanted != (int)hold.to_ulong())
+        {   // exact against the dealer's house rule draw on a worker, a toggle drops the count in flight.
+            // equity's totals belong to the worker until its result comes back through Post()
+            int job = ++equity_job;
+            equity_wanted = (int)hold.to_ulong();
+            equity_hold = -1;
+            equity.Start(table, seat_player2, hold, sRound::DrawPolicy(dealer_hand), [job]
             {
-                player2_hand.cards[id] = deck_ids[deal_index++];
-            }
-            std::cout << "Player: "; DisplayHand(player2_hand);           
+                loop.Post([job] { if (job == equity_job) equity_hold = equity_wanted; });
+            });
         }
-    }
-   
-    // todo: when checking win on a tie, suit matters.
-    //       just compare high card on straight and flush
-    //       or compare high card % 13 for others 
-    //       remember to consider the Ace special case
+        bool more = true;
+        while (more && sEventLoop::clock::now() < deadline) more = odds.Pump(odds_batch);
+        return more;
+    };
+    loop.AddTimer(std::chrono::milliseconds(33), std::chrono::milliseconds(33), []
+    {
+        if (state == state_select && ((!odds_shown_ready && odds.Ready(hold)) || equity_shown != equity_hold)) Render();
+    });
+    Render();
+    loop.Run();
+    equity.Cancel();                                         // before the loop it posts to is gone
 
-    return 0;
+    if (loop.keys_handled)
+        std::cout << "\ninput latency: avg " << (loop.latency_total_ms / loop.keys_handled)
+                  << "ms  max " << loop.latency_max_ms << "ms  (" << loop.keys_handled << " keys)\n";
+    return TraceEnd(trace_path, 0);
 }
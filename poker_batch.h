@@ -0,0 +1,61 @@
+#pragma once
+
+#include "poker_hand.h"
+
+/*
+    Batch evaluator: ranks many hands in one call with the same rank codes as RankHand().
+
+    Each lane is reduced to bit masks (value seen once/twice/..., suits present, joker count)
+    and the rank is picked with selects instead of the sort and early outs RankHand() uses,
+    so the lane loop has no data dependent branches and the optimiser can vectorise it.
+    Jokers are counted as the best card for the hand, the same as trying every substitution.
+*/
+
+static void RankHands(const int (*cards)[5], int count, int* rank)
+{
+    const unsigned royal_window = (15u << 9) | 1u;                    // 10 J Q K A  (A is value 0)
+
+    for (int lane = 0; lane < count; lane++)
+    {
+        unsigned m1 = 0, m2 = 0, m3 = 0, m4 = 0, m5 = 0;              // values seen at least n times
+        unsigned suits = 0;
+        int jokers = 0;
+        for (int i = 0; i < 5; i++)
+        {
+            int card = cards[lane][i];
+            unsigned natural = 0u - (unsigned)(card < joker_card);     // all ones for a standard card
+            unsigned bit = (1u << (card % 13)) & natural;
+            m5 |= m4 & bit;
+            m4 |= m3 & bit;
+            m3 |= m2 & bit;
+            m2 |= m1 & bit;
+            m1 |= bit;
+            suits |= (1u << ((card - 1) / 13)) & natural;
+            jokers += (int)(card >= joker_card);
+        }
+
+        int group = (m5 ? 5 : m4 ? 4 : m3 ? 3 : m2 ? 2 : 1) + jokers;
+        bool one_suit  = (suits & (suits - 1)) == 0;
+        bool two_pair  = (m2 & (m2 - 1)) != 0;
+        bool full      = (m3 != 0 && two_pair) || (jokers == 1 && two_pair);
+
+        unsigned fits = 0;                                             // naturals fit some 5 value window
+        for (int low = 0; low < 9; low++)
+            fits |= (unsigned)((m1 & ~(31u << low)) == 0);
+        bool royal    = m2 == 0 && (m1 & ~royal_window) == 0;
+        bool straight = m2 == 0 && (fits || royal);
+
+        int r = 0;
+        r = (group >= 2) ? 4 : r;
+        r = (two_pair && jokers == 0) ? 8 : r;
+        r = (group >= 3) ? 12 : r;
+        r = straight ? 14 : r;
+        r = one_suit ? 15 : r;
+        r = full ? 16 : r;
+        r = (group >= 4) ? 24 : r;
+        r = (group >= 5) ? 28 : r;
+        r = (straight && one_suit) ? 29 : r;
+        r = (royal && one_suit) ? 30 : r;
+        rank[lane] = r;
+    }
+}
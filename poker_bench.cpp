@@ -0,0 +1,384 @@
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+#include "poker_round.h"
+#include "poker_batch.h"
+#include "poker_display.h"
+#include "poker_showdown.h"
+#include "poker_policy.h"
+#include "poker_equity.h"
+#include "poker_index.h"
+
+/*
+    Microbenchmarks for the hot paths: RankHand(), RankHands(), HandStrength(), PolicyStrengths()
+    for each ranking policy, HandIndex() both ways, RankShowdown(), sRound::Deal(), a whole headless round, heads-up
+    equity and Display()/DisplayHand() into a null sink.
+
+    poker_bench [-out results.json] [-baseline bench_baseline.json] [-threshold 0.25]
+
+    Every corpus comes from a fixed seed so runs compare like for like. Each result
+    is the best of several repeats (ns per op) plus a checksum of what was computed.
+    Against a baseline the run fails when a benchmark is slower than baseline * (1 + threshold)
+    or when a checksum differs, since then the code no longer does the same work.
+*/
+
+const int corpus_size = 1 << 16;
+const int repeats = 15;                                      // best of, shared machines are noisy
+
+
+struct sResult
+{
+    std::string name;
+    double ns_per_op;
+    unsigned long long checksum;
+};
+
+
+struct sNullBuffer : std::streambuf
+{   // swallows everything, keeps the formatting work in the measurement
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+
+struct sWideNullBuffer : std::wstreambuf
+{
+    std::wint_t overflow(std::wint_t c) override { return c; }
+    std::streamsize xsputn(const wchar_t*, std::streamsize n) override { return n; }
+};
+
+
+static std::vector<HandInfo> MakeCorpus(unsigned seed, int min_jokers)
+{   // random hands from the joker deck, min_jokers > 0 forces 1..3 jokers (at least min_jokers) into each hand
+    std::mt19937 mte(seed);
+    std::vector<HandInfo> corpus(corpus_size);
+    int deck[deck_size];
+    std::copy(joker_deck, joker_deck + deck_size, deck);
+    for (HandInfo &hand : corpus)
+    {
+        hand = HandInfo();
+        if (min_jokers == 0)
+        {   // plain deal from the full deck
+            std::shuffle(deck, deck + deck_size, mte);
+            for (int i = 0; i < 5; i++) hand.cards[i] = deck[i];
+            continue;
+        }
+        std::copy(joker_deck, joker_deck + deck_size, deck);
+        std::shuffle(deck, deck + 52, mte);
+        int jokers = min_jokers + (int)(mte() % (unsigned)(4 - min_jokers));
+        std::shuffle(deck + 52, deck + deck_size, mte);
+        for (int i = 0; i < 5; i++) hand.cards[i] = (i < jokers) ? deck[52 + i] : deck[i];
+        std::shuffle(hand.cards, hand.cards + 5, mte);
+    }
+    return corpus;
+}
+
+
+static std::vector<HandInfo> MakeEdgeCases()
+{   // joker hands that lean on the special cases in RankHand()
+    const int edge[][5] =
+    {
+        {  9, 10, 55, 54, 53 },      // debug hand from main(): two cards and three jokers
+        { 13, 12, 11, 10, 53 },      // A K Q J + joker          => royal
+        { 12, 11, 10,  9, 53 },      // K Q J 10 + joker         => royal (joker is the Ace)
+        { 11, 10,  9, 54, 53 },      // Q J 10 + two jokers      => royal
+        { 10,  9, 55, 54, 53 },      // J 10 + three jokers      => royal
+        { 13,  1,  2,  3, 53 },      // wheel + joker
+        { 13,  1,  2, 54, 53 },      // A 2 3 + two jokers
+        {  1,  3,  5, 54, 53 },      // gapped straight flush
+        { 13, 26, 39, 52, 53 },      // four Aces + joker        => five of a kind
+        {  1, 14, 27, 54, 53 },      // trips + two jokers
+        {  1, 14,  2, 15, 53 },      // two pair + joker         => full house
+        {  1, 15, 29, 43, 53 },      // gapped, mixed suits
+        { 12, 13,  1,  2, 53 },      // K A 2 3, no wrap around
+    };
+    std::vector<HandInfo> corpus;
+    while ((int)corpus.size() < corpus_size)
+        for (const auto &cards : edge)
+        {
+            HandInfo hand = HandInfo();
+            for (int i = 0; i < 5; i++) hand.cards[i] = cards[i];
+            corpus.push_back(hand);
+        }
+    corpus.resize(corpus_size);
+    return corpus;
+}
+
+
+template <typename Fn>
+static sResult Measure(const char* name, long long ops, Fn fn)
+{   // best of repeats after one untimed warm up, fn returns a checksum of its work
+    sResult result = { name, 0.0, 0 };
+    double best = 0.0;
+    fn();
+    for (int r = 0; r < repeats; r++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        unsigned long long sum = fn();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || ns < best) best = ns;
+        result.checksum = sum;
+    }
+    result.ns_per_op = best / (double)ops;
+    return result;
+}
+
+
+static unsigned long long RankCorpus(const std::vector<HandInfo> &corpus)
+{
+    unsigned long long sum = 0;
+    for (const HandInfo &h : corpus)
+    {
+        HandInfo hand = h;                       // RankHand sorts in place
+        RankHand(hand);
+        sum = sum * 31 + (unsigned)hand.rank;
+    }
+    return sum;
+}
+
+
+static unsigned long long RankCorpusBatch(const std::vector<HandInfo> &corpus, std::vector<int> &cards, std::vector<int> &rank)
+{
+    for (size_t i = 0; i < corpus.size(); i++)
+        for (int c = 0; c < 5; c++) cards[i * 5 + c] = corpus[i].cards[c];
+    RankHands((const int(*)[5])cards.data(), (int)corpus.size(), rank.data());
+    unsigned long long sum = 0;
+    for (int r : rank) sum = sum * 31 + (unsigned)r;
+    return sum;
+}
+
+
+template <class Policy>
+static unsigned long long PolicyCorpus(const std::vector<HandInfo> &corpus, std::vector<int> &cards, std::vector<unsigned> &key)
+{
+    for (size_t i = 0; i < corpus.size(); i++)
+        for (int c = 0; c < 5; c++) cards[i * 5 + c] = corpus[i].cards[c];
+    PolicyStrengths<Policy>((const int(*)[5])cards.data(), (int)corpus.size(), key.data());
+    unsigned long long sum = 0;
+    for (unsigned k : key) sum = sum * 31 + k;
+    return sum;
+}
+
+
+static std::string ToJson(const std::vector<sResult> &results)
+{
+    std::ostringstream out;
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        out << "    { \"name\": \"" << results[i].name << "\", \"ns_per_op\": " << results[i].ns_per_op
+            << ", \"checksum\": " << results[i].checksum << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+
+static bool ReadBaseline(const char* path, std::vector<sResult> &baseline)
+{   // only reads what ToJson() writes: one benchmark object per line
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        size_t n = line.find("\"name\": \"");
+        size_t t = line.find("\"ns_per_op\": ");
+        size_t c = line.find("\"checksum\": ");
+        if (n == std::string::npos || t == std::string::npos || c == std::string::npos) continue;
+        n += 9;
+        sResult r;
+        r.name = line.substr(n, line.find('"', n) - n);
+        r.ns_per_op = std::atof(line.c_str() + t + 13);
+        r.checksum = std::strtoull(line.c_str() + c + 12, nullptr, 10);
+        baseline.push_back(r);
+    }
+    return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* out_path = nullptr;
+    const char* baseline_path = nullptr;
+    double threshold = 0.25;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "-out") == 0) out_path = argv[i + 1];
+        if (std::strcmp(argv[i], "-baseline") == 0) baseline_path = argv[i + 1];
+        if (std::strcmp(argv[i], "-threshold") == 0) threshold = std::atof(argv[i + 1]);
+    }
+
+    std::vector<HandInfo> mixed = MakeCorpus(20250105, 0);
+    std::vector<HandInfo> jokers = MakeCorpus(53, 1);
+    std::vector<HandInfo> edges = MakeEdgeCases();
+    std::vector<int> cards(corpus_size * 5);
+    std::vector<int> rank(corpus_size);
+    std::vector<sResult> results;
+
+    results.push_back(Measure("RankHand/mixed", corpus_size, [&] { return RankCorpus(mixed); }));
+    results.push_back(Measure("RankHand/jokers", corpus_size, [&] { return RankCorpus(jokers); }));
+    results.push_back(Measure("RankHand/edge_cases", corpus_size, [&] { return RankCorpus(edges); }));
+    results.push_back(Measure("RankHands/mixed", corpus_size, [&] { return RankCorpusBatch(mixed, cards, rank); }));
+    results.push_back(Measure("RankHands/jokers", corpus_size, [&] { return RankCorpusBatch(jokers, cards, rank); }));
+    results.push_back(Measure("RankHands/edge_cases", corpus_size, [&] { return RankCorpusBatch(edges, cards, rank); }));
+
+    std::vector<HandInfo> ranked = mixed;
+    for (HandInfo &hand : ranked) RankHand(hand);
+    results.push_back(Measure("HandStrength/mixed", corpus_size, [&]
+    {
+        unsigned long long sum = 0;
+        for (const HandInfo &hand : ranked) sum = sum * 31 + HandStrength(hand);
+        return sum;
+    }));
+
+    // one instantiation per ranking order, same mixed corpus
+    std::vector<unsigned> policy_key(corpus_size);
+    results.push_back(Measure("PolicyStrengths/high", corpus_size, [&] { return PolicyCorpus<sHighPolicy>(mixed, cards, policy_key); }));
+    results.push_back(Measure("PolicyStrengths/ace_high", corpus_size, [&] { return PolicyCorpus<sAceHighPolicy>(mixed, cards, policy_key); }));
+    results.push_back(Measure("PolicyStrengths/ace_low", corpus_size, [&] { return PolicyCorpus<sAceLowPolicy>(mixed, cards, policy_key); }));
+    results.push_back(Measure("PolicyStrengths/deuce_to_seven", corpus_size, [&] { return PolicyCorpus<sDeuceToSevenPolicy>(mixed, cards, policy_key); }));
+    results.push_back(Measure("PolicyStrengths/ace_to_five", corpus_size, [&] { return PolicyCorpus<sAceToFivePolicy>(mixed, cards, policy_key); }));
+
+    // dense colex index of the same hands, scalar, batch and back. the batch reads a flat copy made
+    // once, so both forms pay for the same work and the difference is the lane loops
+    std::vector<unsigned> hand_index(corpus_size);
+    std::vector<int> index_cards(corpus_size * 5);
+    for (size_t i = 0; i < mixed.size(); i++)
+        for (int c = 0; c < 5; c++) index_cards[i * 5 + c] = mixed[i].cards[c];
+    results.push_back(Measure("HandIndex/mixed", corpus_size, [&]
+    {
+        unsigned long long sum = 0;
+        for (const HandInfo &h : mixed) sum = sum * 31 + HandIndex(h.cards);
+        return sum;
+    }));
+    results.push_back(Measure("HandIndexes/mixed", corpus_size, [&]
+    {
+        HandIndexes((const int(*)[5])index_cards.data(), corpus_size, hand_index.data());
+        unsigned long long sum = 0;
+        for (unsigned index : hand_index) sum = sum * 31 + index;
+        return sum;
+    }));
+    results.push_back(Measure("HandsFromIndexes/mixed", corpus_size, [&]
+    {
+        HandsFromIndexes(hand_index.data(), corpus_size, (int(*)[5])cards.data());
+        unsigned long long sum = 0;
+        for (int card : cards) sum = sum * 31 + (unsigned)card;
+        return sum;
+    }));
+
+    // showdown ordering on the same keys: four seat tables one after another, then one big field
+    std::vector<unsigned> keys(corpus_size);
+    for (int i = 0; i < corpus_size; i++) keys[i] = HandStrength(ranked[i]);
+    std::vector<int> order(corpus_size), group(corpus_size), scratch(corpus_size);
+    results.push_back(Measure("RankShowdown/4_seats", corpus_size / 4, [&]
+    {
+        unsigned long long sum = 0;
+        for (int t = 0; t < corpus_size; t += 4)
+            sum = sum * 31 + (unsigned)RankShowdown(&keys[t], 4, &order[t], &group[t], &scratch[t]) * 4 + (unsigned)order[t];
+        return sum;
+    }));
+    results.push_back(Measure("RankShowdown/65536_field", corpus_size, [&]
+    {
+        unsigned long long sum = (unsigned)RankShowdown(keys.data(), corpus_size, order.data(), group.data(), scratch.data());
+        for (int i = 0; i < 64; i++) sum = sum * 31 + (unsigned)order[i];
+        return sum;
+    }));
+
+    const int rounds = 20000;
+    sRound table;
+    results.push_back(Measure("Deal", rounds, [&]
+    {
+        table.Seed(7);
+        unsigned long long sum = 0;
+        for (int r = 0; r < rounds; r++) { table.Deal(); sum = sum * 31 + (unsigned)table.hands[seat_dealer].cards[0]; }
+        return sum;
+    }));
+    results.push_back(Measure("PlayHeadless/4_seats", rounds, [&]
+    {
+        table.Seed(7);
+        table.seated.set();
+        unsigned long long sum = 0;
+        for (int r = 0; r < rounds; r++) { table.PlayHeadless(); sum = sum * 31 + (unsigned)table.winners.to_ulong(); }
+        return sum;
+    }));
+
+    // exact heads-up equity on one deal, both sides on the house rule (three cards each), one thread
+    sRound heads_up;
+    heads_up.Seed(5);
+    heads_up.Deal();
+    RankHand(heads_up.hands[seat_dealer]);
+    RankHand(heads_up.hands[seat_player2]);
+    sEquity equity;
+    results.push_back(Measure("Equity/heads_up", 1, [&]
+    {
+        equity.Compute(heads_up, seat_player2, sRound::DrawPolicy(heads_up.hands[seat_player2]),
+                       sRound::DrawPolicy(heads_up.hands[seat_dealer]), 1);
+        return (unsigned long long)equity.win * 31 + (unsigned long long)equity.tie;
+    }));
+
+    // output paths into a null sink, the stream state is restored afterwards
+    sNullBuffer null_buffer;
+    sWideNullBuffer wide_null_buffer;
+    std::streambuf* saved = std::cout.rdbuf(&null_buffer);
+    std::wstreambuf* wide_saved = std::wcout.rdbuf(&wide_null_buffer);
+    results.push_back(Measure("Display/null_sink", 55 * 200, []
+    {
+        for (int r = 0; r < 200; r++)
+            for (int card = 1; card <= deck_size; card++) Display(card);
+        return 0ull;
+    }));
+    results.push_back(Measure("DisplayHand/null_sink", corpus_size / 16, [&]
+    {
+        unsigned long long sum = 0;
+        for (int i = 0; i < corpus_size / 16; i++) { HandInfo hand = jokers[i]; DisplayHand(hand); sum += (unsigned)hand.rank; }
+        return sum;
+    }));
+    std::cout.rdbuf(saved);
+    std::wcout.rdbuf(wide_saved);
+
+    for (const sResult &r : results)
+        std::cout << r.name << std::string(r.name.size() < 24 ? 24 - r.name.size() : 1, ' ') << r.ns_per_op << " ns/op\n";
+
+    std::string json = ToJson(results);
+    if (out_path)
+    {
+        std::ofstream out(out_path);
+        out << json;
+    }
+
+    if (!baseline_path) return 0;
+    std::vector<sResult> baseline;
+    if (!ReadBaseline(baseline_path, baseline))
+    {
+        std::cout << "can not read baseline " << baseline_path << "\n";
+        return 1;
+    }
+    int failures = 0;
+    for (const sResult &b : baseline)
+    {
+        for (const sResult &r : results)
+        {
+            if (r.name != b.name) continue;
+            if (r.checksum != b.checksum)
+            {
+                std::cout << "CHECKSUM " << r.name << " changed\n";
+                failures++;
+            }
+            if (r.ns_per_op > b.ns_per_op * (1.0 + threshold))
+            {
+                std::cout << "REGRESSION " << r.name << "  " << b.ns_per_op << " => " << r.ns_per_op << " ns/op\n";
+                failures++;
+            }
+        }
+    }
+    std::cout << (failures ? "FAILED" : "passed") << " against " << baseline_path << " (threshold " << threshold * 100 << "%)\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <iostream>
+#ifdef _WIN32
+#include <io.h>             // console _setmode 
+#include <fcntl.h>          // UTF16 no BOM
+#endif
+#include "poker_hand.h"
+
+#ifndef _ec
+#define _ec(x) "\x1b["#x"m" // console color manipulator
+#endif
+
+/*
+    Card and hand output. Everything goes through std::cout / std::wcout so the
+    benchmarks can point their buffers at a null sink.
+*/
+
+static void Display(int card)
+{   // set color
+    if (card < 14) std::cout << _ec(34);
+    if (card > 13 && card < 27) std::cout << _ec(31);
+    if (card > 26 && card < 40) std::cout << _ec(34);
+    if (card > 39 && card < 53) std::cout << _ec(31);
+    if (card > 52) std::cout << _ec(32);
+    // show card value 
+    int val = card % 13;
+    if (card > 52) val = 52 - card; // jokers go negative
+    if (val < 0) std::cout << "@";
+    if (val > 0 && val < 10) std::cout << (val + 1);
+    if (val == 0)  std::cout << "A";
+    if (val == 10) std::cout << "J";
+    if (val == 11) std::cout << "Q";
+    if (val == 12) std::cout << "K";
+    // show card suit symbol
+#ifdef _WIN32
+    int ret = _setmode(_fileno(stdout), _O_U16TEXT);
+    if (card < 14) std::wcout << L"\u2667" << _ec(37) << L" ";
+    if (card > 13 && card < 27) std::wcout << L"\u2662" << _ec(37) << L" ";
+    if (card > 26 && card < 40) std::wcout << L"\u2664" << _ec(37) << L" ";
+    if (card > 39 && card < 53) std::wcout << L"\u2661" << _ec(37) << L" ";
+    if (card > 52) std::wcout << _ec(37) << L"  ";
+    ret = _setmode(_fileno(stdout), _O_TEXT);
+#else
+    if (card < 14) std::cout << "\u2667" << _ec(37) << " ";         // utf-8 terminals
+    if (card > 13 && card < 27) std::cout << "\u2662" << _ec(37) << " ";
+    if (card > 26 && card < 40) std::cout << "\u2664" << _ec(37) << " ";
+    if (card > 39 && card < 53) std::cout << "\u2661" << _ec(37) << " ";
+    if (card > 52) std::cout << _ec(37) << "  ";
+#endif
+}
+
+
+static void DisplayHand(HandInfo &hand)
+{
+    RankHand(hand);
+    for (int card : hand.cards) Display(card);
+    std::cout << "  rank: " << PokerHandName[hand.rank] << "\n";
+}
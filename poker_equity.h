@@ -0,0 +1,302 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <bitset>
+#include <algorithm>
+#include "poker_round.h"
+#include "poker_batch.h"
+#include "poker_showdown.h"
+#include "poker_index.h"
+
+/*
+    Heads-up equity: one seat against the dealer, both drawing from what is left of deck_ids.
+
+    Exact, every way the draw can fall counts once: the seat replaces its discards with any
+    set of the remainder and the dealer with any set of the cards left after that, which is
+    what a shuffled deck deals with equal chance. Keys are the game's HandStrength(), so
+    win / tie / loss agree with sRound::Showdown().
+
+    Comparing every pair of outcomes is quadratic. Instead the side with fewer outcomes is
+    sorted into one list per subset T of its drawn cards (up to the other side's draw count),
+    and each outcome a of the other side counts what it beats by inclusion-exclusion over the
+    cards it drew, so only the outcomes that do not share a card are left:
+
+        beaten(a) = sum over T in drawn(a) of (-1)^|T| * #{ b : T in drawn(b), key(b) < key(a) }
+
+    Both sides are put in key order with RankShowdown(), so the lists fill already sorted and
+    the asking side walks each list with a cursor instead of searching it. Keys come from
+    RankHands() in batches, keys and counting are both split across threads.
+
+    Compute() counts on the calling thread. Start() counts on a worker thread and calls done()
+    from it when the count is finished, the interactive game posts that back to its loop. Both
+    copy what they need from the table first, so the table can deal again meanwhile. Cancel(),
+    a new Start() or a Compute() drops a count in flight: the loops test cancel once per batch
+    and per outcome, so it stops within a fraction of a millisecond and done() is not called.
+*/
+
+const int equity_batch = 256;                // hands ranked per RankHands() call
+const int equity_min_per_thread = 4096;      // outcomes, smaller jobs stay on the calling thread
+
+
+struct sEquity
+{
+    struct sSide
+    {
+        int hand[5] = {};
+        int draws = 0;                       // cards replaced
+        int draw_at[5] = {};                 // positions replaced
+        int outcomes = 0;                    // C(remaining, draws)
+        std::vector<unsigned char> pick;     // remainder indices drawn, draws per outcome, ascending
+        std::vector<unsigned> key;           // HandStrength() of each outcome
+    };
+
+    long long win = 0;                       // draw pairs, seen from the seat
+    long long tie = 0;
+    long long loss = 0;
+    double seconds = 0.0;
+
+    int remainder[deck_size] = {};
+    int remaining = 0;
+    sSide side[2];                           // 0 the seat, 1 the dealer
+    std::vector<int> start;                  // list of each subset in sorted, by colex id
+    std::vector<int> fill;
+    std::vector<unsigned> sorted;
+    std::vector<int> order, group, scratch;  // RankShowdown() buffers
+    std::atomic<bool> cancel{ false };
+    std::thread worker;                      // Start()'s count, owns every member above until done()
+
+
+    ~sEquity() { Cancel(); }
+
+
+    long long Total() const { return win + tie + loss; }
+    double Win() const  { return Total() ? (double)win / (double)Total() : 0.0; }
+    double Tie() const  { return Total() ? (double)tie / (double)Total() : 0.0; }
+    double Loss() const { return Total() ? (double)loss / (double)Total() : 0.0; }
+
+
+    bool Compute(const sRound &table, int seat, std::bitset<5> hold, std::bitset<5> dealer_hold, int threads = 0)
+    {   // threads <= 0 uses every core
+        Cancel();
+        Load(table, seat, hold, dealer_hold);
+        cancel = false;
+        return Run(threads);
+    }
+
+
+    template <typename Done>
+    void Start(const sRound &table, int seat, std::bitset<5> hold, std::bitset<5> dealer_hold, Done done, int threads = 0)
+    {   // Compute() on a worker thread, done() from that thread once the totals are in
+        Cancel();
+        Load(table, seat, hold, dealer_hold);
+        cancel = false;
+        worker = std::thread([this, done, threads] { if (Run(threads)) done(); });
+    }
+
+
+    void Cancel()
+    {
+        cancel = true;
+        if (worker.joinable()) worker.join();
+    }
+
+
+    bool Cancelled() const { return cancel.load(std::memory_order_relaxed); }
+
+
+    void Load(const sRound &table, int seat, std::bitset<5> hold, std::bitset<5> dealer_hold)
+    {   // everything the count reads, copied so the table is free again
+        remaining = 0;
+        for (unsigned i = table.deal_index; i < (unsigned)deck_size; i++)
+            remainder[remaining++] = table.deck_ids[i];
+        Draws(side[0], table.hands[seat], hold);
+        Draws(side[1], table.hands[seat_dealer], dealer_hold);
+    }
+
+
+    bool Run(int threads)
+    {   // false when cancelled, the totals are then left as they were
+        auto begin = std::chrono::steady_clock::now();
+        if (threads <= 0) threads = std::max(1, (int)std::thread::hardware_concurrency());
+
+        Setup(side[0], threads);
+        if (!Cancelled()) Setup(side[1], threads);
+        if (Cancelled()) return false;
+
+        // lists on the side with fewer outcomes, the other side asks
+        int b = (side[1].outcomes <= side[0].outcomes) ? 1 : 0;
+        int a = 1 - b;
+        long long a_wins = 0, ties = 0, a_losses = 0;
+        Count(side[a], side[b], threads, a_wins, ties, a_losses);
+        if (Cancelled()) return false;
+
+        win  = (a == 0) ? a_wins : a_losses;
+        tie  = ties;
+        loss = (a == 0) ? a_losses : a_wins;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        return true;
+    }
+
+
+    template <typename Fn>
+    static void Split(int count, int threads, Fn fn)
+    {   // fn(part, first, last) on up to threads ranges of [0, count)
+        int parts = std::max(1, std::min(threads, count / equity_min_per_thread));
+        if (parts == 1) { fn(0, 0, count); return; }
+        std::vector<std::thread> pool;
+        for (int t = 0; t < parts; t++)
+            pool.emplace_back([&fn, t, parts, count] { fn(t, (int)((long long)count * t / parts), (int)((long long)count * (t + 1) / parts)); });
+        for (std::thread &worker : pool) worker.join();
+    }
+
+
+    static void Draws(sSide &s, const HandInfo &hand, std::bitset<5> hold)
+    {
+        s.draws = 0;
+        for (int i = 0; i < 5; i++)
+        {
+            s.hand[i] = hand.cards[i];
+            if (!hold[i]) s.draw_at[s.draws++] = i;
+        }
+    }
+
+
+    void Setup(sSide &s, int threads)
+    {   // every draw for this side and its key
+        s.outcomes = (int)HandCount(remaining, s.draws);
+        s.pick.resize((size_t)s.outcomes * s.draws);
+        s.key.resize(s.outcomes);
+
+        int idx[5] = { 0, 1, 2, 3, 4 };
+        for (int o = 0; o < s.outcomes; o++)
+        {   // lexicographic combinations of the remainder
+            for (int j = 0; j < s.draws; j++) s.pick[(size_t)o * s.draws + j] = (unsigned char)idx[j];
+            int j = s.draws - 1;
+            while (j >= 0 && idx[j] == remaining - s.draws + j) j--;
+            if (j < 0) break;
+            idx[j]++;
+            for (int i = j + 1; i < s.draws; i++) idx[i] = idx[i - 1] + 1;
+        }
+
+        Split(s.outcomes, threads, [&](int, int first, int last)
+        {
+            int cards[equity_batch][5];
+            int rank[equity_batch];
+            for (int o = first; o < last && !Cancelled(); o += equity_batch)
+            {
+                int n = std::min(equity_batch, last - o);
+                for (int i = 0; i < n; i++)
+                {
+                    for (int c = 0; c < 5; c++) cards[i][c] = s.hand[c];
+                    for (int j = 0; j < s.draws; j++)
+                        cards[i][s.draw_at[j]] = remainder[s.pick[(size_t)(o + i) * s.draws + j]];
+                }
+                RankHands(cards, n, rank);
+                for (int i = 0; i < n; i++)
+                {
+                    HandInfo h = HandInfo();
+                    for (int c = 0; c < 5; c++) h.cards[c] = cards[i][c];
+                    h.rank = rank[i];
+                    s.key[o + i] = HandStrength(h);
+                }
+            }
+        });
+    }
+
+
+    long long SubsetId(const unsigned char* pick, int sub, const long long* base) const
+    {   // HandIndex() of the picked remainder indices selected by the bits of sub, sized lists first
+        long long id = 0;
+        int t = 0;
+        for (int j = 0; j < 5; j++)
+            if (sub & (1 << j)) id += colex_table.colex[t++][pick[j]];
+        return base[t] + id;
+    }
+
+
+    void Count(const sSide &a, const sSide &b, int threads, long long &a_wins, long long &ties, long long &a_losses)
+    {
+        int most = std::min(a.draws, b.draws);                    // shared cards can not exceed either draw
+        long long base[7] = { 0 };
+        for (int t = 0; t <= most; t++) base[t + 1] = base[t] + HandCount(remaining, t);
+
+        int b_subs[32], a_subs[32], a_shared[32];                 // subsets of a draw with at most most cards
+        int b_count = 0, a_count = 0;
+        for (int sub = 0; sub < 32; sub++)
+        {
+            int shared = (int)std::bitset<5>(sub).count();
+            if (shared > most) continue;
+            if (sub < (1 << b.draws)) b_subs[b_count++] = sub;
+            if (sub < (1 << a.draws)) { a_subs[a_count] = sub; a_shared[a_count++] = shared; }
+        }
+
+        // b's keys per subset of its drawn cards, filled weakest first so every list comes out sorted
+        start.assign((size_t)base[most + 1] + 1, 0);
+        if (Cancelled()) return;
+        for (int o = 0; o < b.outcomes; o++)
+            for (int k = 0; k < b_count; k++) start[SubsetId(&b.pick[(size_t)o * b.draws], b_subs[k], base) + 1]++;
+        for (size_t i = 1; i < start.size(); i++) start[i] += start[i - 1];
+        sorted.resize(start.back());
+        fill.assign(start.begin(), start.end() - 1);
+        Order(b);
+        for (int i = b.outcomes - 1; i >= 0; i--)
+        {
+            int o = order[i];
+            for (int k = 0; k < b_count; k++) sorted[fill[SubsetId(&b.pick[(size_t)o * b.draws], b_subs[k], base)]++] = b.key[o];
+        }
+
+        // a weakest first, so each list is walked once by a cursor instead of searched
+        if (Cancelled()) return;
+        Order(a);
+        const long long disjoint = (long long)HandCount(remaining - a.draws, b.draws);
+        std::vector<long long> part(3 * (size_t)threads, 0);     // wins, ties, losses per thread
+        Split(a.outcomes, threads, [&](int part_index, int first, int last)
+        {
+            std::vector<int> lower(start.begin(), start.end() - 1);  // first key >= the current one
+            std::vector<int> upper(lower);                           // first key > the current one
+            long long below = 0, equal = 0;
+            for (int i = a.outcomes - 1 - first; i > a.outcomes - 1 - last && !Cancelled(); i--)
+            {
+                int o = order[i];
+                const unsigned char* pick = &a.pick[(size_t)o * a.draws];
+                unsigned key = a.key[o];
+                for (int k = 0; k < a_count; k++)
+                {
+                    long long id = SubsetId(pick, a_subs[k], base);
+                    int end = start[id + 1];
+                    int &lo = lower[id];
+                    int &hi = upper[id];
+                    while (lo < end && sorted[lo] < key) lo++;
+                    if (hi < lo) hi = lo;
+                    while (hi < end && sorted[hi] <= key) hi++;
+                    long long sign = (a_shared[k] & 1) ? -1 : 1;
+                    below += sign * (lo - start[id]);
+                    equal += sign * (hi - lo);
+                }
+            }
+            part[3 * part_index + 0] = below;
+            part[3 * part_index + 1] = equal;
+            part[3 * part_index + 2] = (long long)(last - first) * disjoint - below - equal;
+        });
+        a_wins = ties = a_losses = 0;
+        for (int t = 0; t < threads; t++)
+        {
+            a_wins   += part[3 * t + 0];
+            ties     += part[3 * t + 1];
+            a_losses += part[3 * t + 2];
+        }
+    }
+
+
+    void Order(const sSide &s)
+    {   // outcomes strongest first, RankShowdown() sorts in linear time
+        order.resize(s.outcomes);
+        group.resize(s.outcomes);
+        scratch.resize(s.outcomes);
+        RankShowdown(s.key.data(), s.outcomes, order.data(), group.data(), scratch.data());
+    }
+
+};
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+// https://en.wikipedia.org/wiki/Glossary_of_poker_terms
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX                     // keeps Windows.h from defining min() and max() over std::min and std::max
+#endif
+#include <Windows.h>                 // COORD
+#else
+struct COORD { short X; short Y; };  // console position stand-in off Windows
+#endif
+
+/*
+    Hand rules shared by the interactive game and the headless runners.
+    Nothing in here touches the console so it can be driven from any thread.
+*/
+
+const int deck_size  = 55;                                   // 52 + three jokers
+const int joker_card = 53;                                   // first joker id (53, 54, 55)
+
+const int joker_deck[deck_size] =
+{
+ // 2,  3,  4,  5,  6,  7,  8,  9, 10,  J,  Q,  K,  A        // (card % 13) => 1..12, 0 is the Ace
+        1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13,   // club grouping
+       14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,   // diamond grouping
+       27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,   // spade grouping
+       40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52,   // heart grouping
+       53, 54, 55                                            // three wildcard jokers
+};
+
+static const char* const PokerHandName[31] =
+{                                                                
+    "high card", "", "", "",       // 0
+    "one pair", "", "", "",        // 4        (2(2))
+    "two pair", "", "", "",        // 8        (2(4))
+    "three of a kind", "",         // 12       (2(6))
+    "straight",                    // 14        
+    "flush",                       // 15  
+    "full house", "", "", "",      // 16       (2(8))
+    "", "", "", "",                //     
+    "four of a kind", "", "", "",  // 24       (2(12))
+    "five of a kind",              // 28       (2(14))
+    "staight flush",               // 29         
+    "royal straight flush"         // 30        
+};
+
+
+struct HandInfo
+{
+    int cards[5];                 // actual card ID from the deck
+    int high_card;                // used on zero ranking
+    std::bitset<3> jokers;        // track jokers in hand
+    int rank;                     // used for determining hand strength
+    COORD pos;                    // this players screen position 
+};
+
+static void RankHand(HandInfo &hand)
+{
+    //   solveable by comparison   |   determine by additional steps                    
+    // ============================|=================================
+    //  nothing       =  0  (0)    |          (high card)
+    //  one pair      =  2  (4)    |
+    //  two pair      =  4  (8)    |
+    //  three of kind =  6  (12)   |
+    //                      (14)   |          (straight)
+    //                      (15)   |            (flush)                        
+    //  full house    =  8  (16)   |
+    //  four of kind  = 12  (24)   |
+    //  five of kind  = 14  (28)   |                                     <---- at least one joker present
+    //                      (29)   |         (straight flush)
+    //                      (30)   |      (royal straight flush)
+
+    hand.high_card = 0;
+    hand.rank = 0;
+    hand.jokers.reset();
+    bool flush_found    = false;
+    bool straight_found = false;
+    bool make_ace_high  = false;
+    
+
+    // find high card ---------------------------------------------------------------------------
+    for (int i = 0; i < 5; i++)
+    {
+        if (hand.cards[i] > 52)
+        {   // handle jokers
+            if (hand.cards[i] > hand.high_card)
+                hand.high_card = hand.cards[i];
+            if (hand.cards[i] == 53) hand.jokers.set(0);
+            if (hand.cards[i] == 54) hand.jokers.set(1);
+            if (hand.cards[i] == 55) hand.jokers.set(2);
+        }
+        else 
+        {   // handle standard deck
+            int a = hand.high_card % 13;
+            int b = hand.cards[i] % 13;
+            if (a == 0) a = 13;
+            if (b == 0) b = 13;
+            if (hand.high_card > 52)
+            {
+                if (hand.cards[i] > hand.high_card)
+                    hand.high_card = hand.cards[i];
+            }
+            else if ((b > a))  hand.high_card = hand.cards[i];
+            else if (b == a)
+            {   // choose the higher suit of this card value
+                if (hand.cards[i] > hand.high_card)
+                    hand.high_card = hand.cards[i];
+            }
+        }
+    }
+
+    size_t offset = 0;                                                         // jokers in hand, a multi-deck shoe
+    for (int card : hand.cards) if (card > 52) offset++;                       // can repeat a joker id
+    if (offset == 5) { hand.rank = 30; return; }                               // all wild
+
+    // check for flush hand (a shoe can repeat cards, pairs do not rule it out) ----------------------
+    std::bitset<4> suit_bitset;
+    for (int i = 0; i < 5; i++)
+    {
+        if (hand.cards[i] < 14) suit_bitset.set(0);                            // clubs
+        if (hand.cards[i] > 13 && hand.cards[i] < 27) suit_bitset.set(1);     // diamonds
+        if (hand.cards[i] > 26 && hand.cards[i] < 40) suit_bitset.set(2);     // spades
+        if (hand.cards[i] > 39 && hand.cards[i] < 53) suit_bitset.set(3);     // hearts
+    }                                                                           // absolutely no need to test for jokers present
+    if (suit_bitset.count() == 1) flush_found = true;
+    
+    // process rank solvable by comparison -----------------------------------------------------------
+    for (int i = 0; i < 5; i++) 
+    {
+        for (int j = 0; j < 5; j++)
+        {
+            if (hand.cards[i] > 52 || hand.cards[j] > 52) continue;
+
+            if (i != j && ((hand.cards[j] % 13) == (hand.cards[i] % 13)))
+                hand.rank++;
+        }
+    }   
+    hand.rank *= 2;                                                            // double result to make room for additional ranks
+    if (hand.rank == 40) { hand.rank = 28; return; }                           // five of a kind (multi-deck shoe)
+    if ((hand.rank > 0) && (offset == 0))                                      // early out (can not be straight)
+    {
+        if (flush_found && hand.rank < 16) hand.rank = 15;                     // suited repeats from a shoe
+        return;
+    }
+    // handle jokers
+    if ((hand.rank == 24) && (offset == 1)) { hand.rank = 28; return; }       // four of a kind -> five of a kind
+    if ((hand.rank == 12) && (offset == 1)) { hand.rank = 24; return; }       // three of a kind -> four of a kind
+    if ((hand.rank == 12) && (offset == 2)) { hand.rank = 28; return; }       // three of a kind -> five of a kind
+    if ((hand.rank == 8) && (offset == 1))  { hand.rank = 16; return; }       // two pair -> full house
+    if ((hand.rank == 4) && (offset == 1))  { hand.rank = flush_found ? 15 : 12; return; }  // one pair -> three of a kind (or flush)
+    if ((hand.rank == 4) && (offset == 2))  { hand.rank = 24; return; }       // one pair -> four of a kind
+    if ((hand.rank == 4) && (offset == 3))  { hand.rank = 28; return; }       // one pair -> five of a kind
+   
+    // check for straight ----------------------------------------------------------------------------
+    std::sort(hand.cards, hand.cards + 5, 
+        [](const int& first, const int& second) -> bool
+        {   // keeping connection to deck representation (handle Ace later)
+            if ((first < 53) && (second < 53)) 
+            {   // don't check jokers here
+                return ((first % 13) < (second % 13));
+            }
+            else {
+                // handle joker
+                return first > second; // stack jokers up front in decending order
+            }
+        }
+    );
+    straight_found = true; //default true for sequential test
+    if ((offset < 4) && (hand.cards[offset] % 13 == 0) && ((hand.cards[4] % 13 == 12) || (hand.cards[offset + 1] % 13 >= 9)))
+    {   // King (or only 10 and up) is present. swap Ace to the back.
+        make_ace_high = true;
+        std::rotate(&hand.cards[offset], &hand.cards[offset] + 1, &hand.cards[5]);
+    }
+    int error_count = (int)offset;                                             // jokers left to fill gaps
+    for (size_t i = offset; i < 4; i++)
+    {
+        int a = hand.cards[i] % 13;
+        int b = hand.cards[i + 1] % 13;
+        if (make_ace_high)
+        {
+            if (a == 0) a = 13;
+            if (b == 0) b = 13;
+        }
+
+        if(b - a != 1)
+        {
+            if (b - a - 1 <= error_count)
+            {   // one joker per missing card
+                error_count -= (b - a - 1);
+                continue;
+            }
+            else
+                straight_found = false;
+        }
+    }
+
+    // final rank determination from gathered information --------------------------------------------
+    if (straight_found && flush_found)                                                
+    {
+        bool royal = true;                                                           // royal flush when every
+        for (size_t i = offset; i < 5; i++)                                          // natural card is 10 => A
+            if ((hand.cards[i] % 13 != 0) && (hand.cards[i] % 13 < 9)) royal = false;
+        hand.rank = royal ? 30 : 29;                                                 // else straight flush
+    }
+    else if (offset == 3) hand.rank = 24;                                            // (jokers) four of kind beats flush
+    else if (flush_found) hand.rank = 15;                                            // flush
+    else if (straight_found) hand.rank = 14;                                         // straight
+    else if (offset == 1) hand.rank = 4;                                             // (joker) one pair
+    else if (offset == 2) hand.rank = 12;                                            // (jokers) three of kind
+}
+
+
+static bool IsJoker(int card) { return card >= joker_card; }
+static int  CardSuit(int card) { return (card - 1) / 13; }          // 0 club, 1 diamond, 2 spade, 3 heart
+static int  CardValue(int card) { return (card % 13 + 12) % 13; }   // ace high: 2 => 0 ... K => 11, A => 12
+
+
+static unsigned HandStrength(const HandInfo &hand)
+{   // comparable showdown key, requires RankHand() first
+    //
+    //   bits 22..26  hand.rank
+    //   bits  2..21  five kicker values (4 bits each, most significant first)
+    //   bits  0..1   suit of the highest natural card (the todo from main: "on a tie, suit matters")
+    //
+    // jokers take whatever value the rank implies: they join the leading group,
+    // fill the top of a straight, or become the highest missing flush cards.
+
+    int count[13] = { 0 };
+    int jokers = 0;
+    int top_card = 0;
+    unsigned value_mask = 0;
+    for (int card : hand.cards)
+    {
+        if (IsJoker(card)) { jokers++; continue; }
+        count[CardValue(card)]++;
+        value_mask |= 1u << CardValue(card);
+        if (top_card == 0 || (CardValue(card) * 4 + CardSuit(card)) > (CardValue(top_card) * 4 + CardSuit(top_card)))
+            top_card = card;
+    }
+
+    unsigned kickers = 0;
+    int pushed = 0;
+    auto push = [&](int value) { kickers = (kickers << 4) | (unsigned)value; pushed++; };
+
+    if (hand.rank == 14 || hand.rank == 29)
+    {   // straight: highest window that holds every natural card
+        int high = -1;
+        for (int t = 12; t >= 4 && high < 0; t--)
+            if ((value_mask & ~(31u << (t - 4))) == 0) high = t;
+        if (high < 0 && (value_mask & ~((1u << 12) | 15u)) == 0) high = 3;  // wheel, the Ace plays low
+        if (high < 0) for (int v = 12; v >= 0 && high < 0; v--) if (count[v]) high = v;
+        push(high);
+    }
+    else if (hand.rank == 15)
+    {   // flush: jokers become the highest cards missing from the suit
+        unsigned filled = value_mask;
+        for (int v = 12, j = jokers; v >= 0 && j > 0; v--)
+            if (!(filled & (1u << v))) { filled |= 1u << v; j--; }
+        for (int v = 12; v >= 0; v--) if (filled & (1u << v)) push(v);
+    }
+    else if (hand.rank != 30)
+    {   // grouped hands: bigger groups first, then higher value
+        for (int n = 5; n > 0; n--)
+            for (int v = 12; v >= 0; v--)
+                if (count[v] == n) push(v);
+    }
+    while (pushed < 5) push(0);
+
+    unsigned suit = top_card ? (unsigned)CardSuit(top_card) : 0;
+    return ((unsigned)hand.rank << 22) | (kickers << 2) | suit;
+}
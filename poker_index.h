@@ -0,0 +1,163 @@
+#pragma once
+
+#include "poker_hand.h"
+
+/*
+    Dense hand index: a set of k distinct cards <=> an integer in [0, C(n, k)).
+
+    Colex order. Card ids 1..n become 0..n-1 and a sorted set c0 < c1 < ... < ck-1 gets
+    C(c0, 1) + C(c1, 2) + ... + C(ck-1, k). The order does not depend on n, so the sets of
+    the 52 card deck are exactly the first C(52, k) indexes of the joker deck: one mapping
+    serves both decks and every hand size up to 5 (the held part of a hand while drawing).
+    Cards must be distinct, the repeats a multi-deck shoe deals have no index.
+
+    Everything reads one constexpr table. HandIndex() finds each card's sorted position by
+    counting the cards below it and adds one table load per card, no sort and no branches.
+    HandFromIndex() walks back down: the top bits of what is left of the index pick a bucket,
+    the bucket holds the largest card that fits its lowest index, and the card is at most a
+    step or two above that outside the first few buckets, where the binomials are dense.
+
+    The batch forms work on index_lanes hands at a time with the lanes in the inner loops.
+    HandIndexes() sorts every lane with the same nine compare-exchanges, which the optimiser
+    turns into vector min/max, then adds the five table loads. HandsFromIndexes() keeps the
+    unrank chain of each hand but runs the lanes side by side, so their loads overlap instead
+    of waiting on one another.
+*/
+
+const int max_index_cards = 5;
+const int index_bucket_bits = 11;                            // HandFromIndex() buckets per card position, 2^n
+const int index_lanes = 16;                                  // hands per block in the batch forms
+
+
+struct sColexTable
+{
+    unsigned count[deck_size + 1][max_index_cards + 1];      // [n][k] = C(n, k)
+    unsigned colex[max_index_cards][64];                     // [i][c] = C(c, i + 1), card c in sorted position i,
+                                                             // padded past the deck for HandFromIndex()
+    unsigned char start[max_index_cards][1 << index_bucket_bits];   // [i][b] = largest c with colex[i][c] <= b << shift[i]
+    int shift[max_index_cards];                              // fits C(deck_size, i + 1) indexes in the buckets
+
+    constexpr sColexTable() : count(), colex(), start(), shift()
+    {
+        for (int n = 0; n <= deck_size; n++)
+            for (int k = 0; k <= max_index_cards; k++)
+                count[n][k] = (k == 0) ? 1 : (n == 0) ? 0 : count[n - 1][k - 1] + count[n - 1][k];
+        for (int i = 0; i < max_index_cards; i++)
+            for (int c = 0; c < 64; c++) colex[i][c] = (c < deck_size) ? count[c][i + 1] : 0xFFFFFFFFu;
+        for (int i = 0; i < max_index_cards; i++)
+        {
+            while (((count[deck_size][i + 1] - 1) >> shift[i]) >> index_bucket_bits) shift[i]++;
+            int c = 0;
+            for (unsigned b = 0; b < (1u << index_bucket_bits); b++)
+            {
+                while (colex[i][c + 1] <= (b << shift[i])) c++;
+                start[i][b] = (unsigned char)c;
+            }
+        }
+    }
+};
+
+constexpr sColexTable colex_table;
+
+
+constexpr unsigned HandCount(int n, int k) { return colex_table.count[n][k]; }    // indexes of k cards from n
+
+static_assert(HandCount(52, 5) == 2598960, "52 card deck");
+static_assert(HandCount(deck_size, 5) == 3478761, "joker deck");
+
+
+constexpr unsigned HandIndex(const int* cards, int k)
+{   // k = 0..5 distinct card ids in any order. a card's sorted position is the number of
+    // cards below it, counted with compares instead of sorting, so there is nothing to mispredict
+    unsigned index = 0;
+    for (int i = 0; i < k; i++)
+    {
+        int below = 0;
+        for (int j = 0; j < k; j++) below += (int)(cards[j] < cards[i]);
+        index += colex_table.colex[below][cards[i] - 1];
+    }
+    return index;
+}
+
+
+constexpr unsigned HandIndex(const int cards[5]) { return HandIndex(cards, 5); }
+
+
+constexpr int IndexCard(unsigned index, int i)
+{   // largest c with C(c, i + 1) <= index, from its bucket up
+    int c = colex_table.start[i][index >> colex_table.shift[i]];
+    while (colex_table.colex[i][c + 1] <= index) c++;
+    return c;
+}
+
+
+constexpr void HandFromIndex(unsigned index, int k, int* cards)
+{   // inverse of HandIndex(), card ids ascending. index < HandCount(n, k) gives cards of 1..n
+    for (int i = k - 1; i >= 0; i--)
+    {   // the card in position i is always below the one above it
+        int c = IndexCard(index, i);
+        cards[i] = c + 1;
+        index -= colex_table.colex[i][c];
+    }
+}
+
+
+static inline void SortPair(int &a, int &b)
+{   // compare-exchange, a select each way
+    int low = (a < b) ? a : b;
+    int high = (a < b) ? b : a;
+    a = low;
+    b = high;
+}
+
+
+static inline void HandIndexes(const int (*cards)[5], int count, unsigned* index)
+{   // batch HandIndex() of five card hands
+    int lane = 0;
+    for (; lane + index_lanes <= count; lane += index_lanes)
+    {
+        int c[5][index_lanes];                               // card position major, one row per sorting network wire
+        for (int l = 0; l < index_lanes; l++)
+            for (int i = 0; i < 5; i++) c[i][l] = cards[lane + l][i] - 1;
+        for (int l = 0; l < index_lanes; l++)
+        {   // optimal five input sorting network
+            SortPair(c[0][l], c[1][l]); SortPair(c[3][l], c[4][l]); SortPair(c[2][l], c[4][l]);
+            SortPair(c[2][l], c[3][l]); SortPair(c[0][l], c[3][l]); SortPair(c[0][l], c[2][l]);
+            SortPair(c[1][l], c[4][l]); SortPair(c[1][l], c[3][l]); SortPair(c[1][l], c[2][l]);
+        }
+        for (int l = 0; l < index_lanes; l++)
+        {
+            unsigned sum = 0;
+            for (int i = 0; i < 5; i++) sum += colex_table.colex[i][c[i][l]];
+            index[lane + l] = sum;
+        }
+    }
+    for (; lane < count; lane++) index[lane] = HandIndex(cards[lane]);
+}
+
+
+static inline void HandsFromIndexes(const unsigned* index, int count, int (*cards)[5])
+{   // batch HandFromIndex() of five card hands
+    int lane = 0;
+    for (; lane + index_lanes <= count; lane += index_lanes)
+    {
+        unsigned rest[index_lanes];
+        for (int l = 0; l < index_lanes; l++) rest[l] = index[lane + l];
+        for (int i = 4; i >= 0; i--)
+            for (int l = 0; l < index_lanes; l++)
+            {
+                int c = colex_table.start[i][rest[l] >> colex_table.shift[i]];
+                c += (int)(colex_table.colex[i][c + 1] <= rest[l]);     // the usual last step, no branch
+                while (colex_table.colex[i][c + 1] <= rest[l]) c++;
+                cards[lane + l][i] = c + 1;
+                rest[l] -= colex_table.colex[i][c];
+            }
+    }
+    for (; lane < count; lane++) HandFromIndex(index[lane], 5, cards[lane]);
+}
+
+
+constexpr int index_first_hand[5] = { 5, 4, 3, 2, 1 };
+constexpr int index_last_hand[5]  = { 55, 54, 53, 52, 51 };
+static_assert(HandIndex(index_first_hand) == 0, "first set");
+static_assert(HandIndex(index_last_hand) == HandCount(deck_size, 5) - 1, "last set");
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <random>
+#include <bitset>
+#include "poker_round.h"
+#include "poker_batch.h"
+
+/*
+    Multi-hand play: the cards held from one dealt hand are copied into N hands,
+    each hand draws its replacements from its own shuffle of what is left in the deck
+    and all N (plus the dealer) are ranked with one RankHands() call.
+
+    The dealer draws first so no hand can receive a card the dealer holds.
+    Each hand is a partial Fisher-Yates over the shared remainder, any order of the
+    remainder is a valid start so the hands stay independent without copying the deck.
+*/
+
+const int max_multi_hands = 100;
+
+
+struct sMultiHand
+{
+    int hand_count = 10;
+    int cards[max_multi_hands + 1][5];       // last used row (hand_count) is the dealer
+    int rank[max_multi_hands + 1];
+    int result[max_multi_hands];             // -1 loss, 0 push, 1 win against the dealer
+    int wins = 0;
+    int pushes = 0;
+    int losses = 0;
+
+
+    void Play(sRound &table, int seat, std::bitset<5> hold)
+    {
+        table.DealerDraw();
+
+        int* remainder = table.deck_ids + table.deal_index;
+        int remaining = deck_size - (int)table.deal_index;
+        const HandInfo &dealt = table.hands[seat];
+
+        for (int h = 0; h < hand_count; h++)
+        {
+            int next = 0;
+            for (int i = 0; i < 5; i++)
+            {
+                if (hold[i]) { cards[h][i] = dealt.cards[i]; continue; }
+                std::uniform_int_distribution<int> pick(next, remaining - 1);
+                std::swap(remainder[next], remainder[pick(table.mte)]);
+                cards[h][i] = remainder[next++];
+            }
+        }
+        for (int i = 0; i < 5; i++) cards[hand_count][i] = table.hands[seat_dealer].cards[i];
+
+        RankHands(cards, hand_count + 1, rank);
+        Resolve(table, seat);
+    }
+
+
+    void Resolve(sRound &table, int seat)
+    {   // rank decides, kickers only when the dealer holds the same rank
+        HandInfo dealer = table.hands[seat_dealer];
+        dealer.rank = rank[hand_count];
+        unsigned dealer_strength = HandStrength(dealer);
+
+        wins = pushes = losses = 0;
+        for (int h = 0; h < hand_count; h++)
+        {
+            int r = (rank[h] > dealer.rank) - (rank[h] < dealer.rank);
+            if (r == 0)
+            {
+                HandInfo hand = { { cards[h][0], cards[h][1], cards[h][2], cards[h][3], cards[h][4] } };
+                hand.rank = rank[h];
+                unsigned strength = HandStrength(hand);
+                r = (strength > dealer_strength) - (strength < dealer_strength);
+            }
+            result[h] = r;
+            if (r > 0) wins++;
+            if (r == 0) pushes++;
+            if (r < 0) losses++;
+        }
+
+        // one ante per hand, a push returns it
+        table.chips[seat] += (wins - losses) * table.ante;
+        table.chips[seat_dealer] -= (wins - losses) * table.ante;
+    }
+
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <bitset>
+#include "poker_round.h"
+#include "poker_batch.h"
+
+/*
+    Outs and odds for the draw: for every hold selection (32 of them) the exact
+    chance of finishing in each rank, enumerated over every draw from the cards
+    left after deal_index.
+
+    Begin() copies the remainder once, then the selections are walked in small steps,
+    always the one the player is looking at first, so toggling a card is normally
+    just a lookup and input is never held up. The steps run either on a worker thread
+    or from the event loop's idle slices through Pump().
+*/
+
+const int odds_batch = 256;                  // hands ranked per RankHands() call
+
+
+struct sOdds
+{
+    struct sHold
+    {
+        int discards = 0;
+        int idx[5] = {};                     // combination cursor into remainder
+        long long total = 0;                 // C(remaining, discards)
+        std::atomic<long long> counted{ 0 };
+        long long category[31] = {};
+        std::atomic<bool> done{ false };
+    };
+
+    int hand[5] = {};
+    int remainder[deck_size] = {};
+    int remaining = 0;
+    sHold hold[32];                          // bit i set => card i is held
+    std::atomic<int> wanted{ 31 };
+    std::atomic<bool> stop{ false };
+    std::thread worker;
+    int batch[odds_batch][5];
+    int batch_rank[odds_batch];
+
+
+    ~sOdds() { Stop(); }
+
+
+    void Begin(const sRound &table, int seat, bool threaded = true)
+    {
+        Stop();
+        for (int i = 0; i < 5; i++) hand[i] = table.hands[seat].cards[i];
+        remaining = 0;
+        for (unsigned i = table.deal_index; i < (unsigned)deck_size; i++)
+            remainder[remaining++] = table.deck_ids[i];
+
+        for (int mask = 0; mask < 32; mask++)
+        {
+            sHold &h = hold[mask];
+            h.discards = 5 - (int)std::bitset<5>(mask).count();
+            for (int j = 0; j < 5; j++) h.idx[j] = j;
+            h.total = 1;
+            for (int j = 0; j < h.discards; j++) h.total = h.total * (remaining - j) / (j + 1);
+            h.counted = 0;
+            for (long long &c : h.category) c = 0;
+            h.done = false;
+        }
+
+        stop = false;
+        if (threaded) worker = std::thread([this] { Run(); });
+    }
+
+
+    void Stop()
+    {
+        stop = true;
+        if (worker.joinable()) worker.join();
+    }
+
+
+    void Select(std::bitset<5> held) { wanted = (int)held.to_ulong(); }
+    bool Ready(std::bitset<5> held) const { return hold[held.to_ulong()].done.load(std::memory_order_acquire); }
+
+
+    void Run()
+    {
+        while (!stop && Pump(16 * odds_batch)) {}
+    }
+
+
+    bool Pump(int budget)
+    {   // the wanted selection first, then the rest in order. false once all are counted
+        int mask = wanted;
+        if (hold[mask].done)
+        {
+            mask = -1;
+            for (int m = 0; m < 32 && mask < 0; m++)
+                if (!hold[m].done) mask = m;
+            if (mask < 0) return false;
+        }
+        Step(mask, budget);
+        return true;
+    }
+
+
+    void Step(int mask, int budget)
+    {   // advance one selection by up to budget draws
+        sHold &h = hold[mask];
+        while (budget > 0 && h.counted < h.total)
+        {
+            int n = 0;
+            while (n < odds_batch && h.counted + n < h.total)
+            {
+                for (int i = 0, d = 0; i < 5; i++)
+                    batch[n][i] = (mask & (1 << i)) ? hand[i] : remainder[h.idx[d++]];
+                n++;
+                NextCombination(h);
+            }
+            RankHands(batch, n, batch_rank);
+            for (int i = 0; i < n; i++) h.category[batch_rank[i]]++;
+            h.counted += n;
+            budget -= n;
+        }
+        if (h.counted == h.total) h.done.store(true, std::memory_order_release);
+    }
+
+
+    void NextCombination(sHold &h)
+    {   // lexicographic k-combination of remaining
+        int k = h.discards;
+        int j = k - 1;
+        while (j >= 0 && h.idx[j] == remaining - k + j) j--;
+        if (j < 0) return;
+        h.idx[j]++;
+        for (int i = j + 1; i < k; i++) h.idx[i] = h.idx[i - 1] + 1;
+    }
+
+};
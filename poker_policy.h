@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include "poker_hand.h"
+
+/*
+    Ranking orders as compile-time policies.
+
+    RankHand() and PokerHandName fix one order: high hand, the Ace ends a straight at either
+    end (the make_ace_high rotation). A policy is a struct of static constexpr tables, and
+    PolicyStrength<Policy>() is instantiated once per order, so every variant gets its own
+    tables and code and no flag is tested per card or per hand:
+
+        value[13]         card % 13 => card value 0..12, higher is the higher card
+        window[]          straights as value masks, highest first (none => straights do not count)
+        window_top[]      top value of each window, the straight's kicker
+        flushes           a suited hand is a flush (and a straight flush)
+        royal             a suited 10 J Q K A is its own rank (30)
+        lowball           the lowest hand wins
+        name              what poker -batch calls it
+
+    The key has the HandStrength() layout: rank << 22, up to five kicker values << 2 (each
+    value once, bigger groups first, a straight only its top card, a royal none) and the suit
+    of the highest natural card in bits 0..1. sHighPolicy gives exactly HandStrength()'s key,
+    poker_verify checks every hand. Bigger is always better, lowball inverts the rank and the
+    kickers (a tie on both still goes to the higher suit), so RankShowdown() orders any policy
+    and sPolicyRound<Policy> plays it.
+    Jokers take whatever value is best for the policy: the leading group, the top of a
+    straight or the highest missing flush cards for high hands, the lowest values that
+    neither pair nor make a straight for lowball (they can always dodge a flush).
+
+    sHighPolicy gives the same rank codes as RankHand(), poker_verify checks every policy
+    against a joker substitution reference (-policies).
+*/
+
+constexpr int ace_high_value[13] = { 12, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };   // card % 13 is 0 for the Ace
+constexpr int ace_low_value[13]  = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+
+constexpr unsigned StraightWindow(int top) { return 31u << (top - 4); }
+
+static int TopValue(unsigned mask) { int v = 12; while (v > 0 && !(mask & (1u << v))) v--; return v; }
+
+
+struct sHighPolicy
+{   // the game's order, A 2 3 4 5 and 10 J Q K A both count
+    static constexpr const char* name = "high";
+    static constexpr bool lowball = false;
+    static constexpr bool flushes = true;
+    static constexpr bool royal   = true;
+    static constexpr const int* value = ace_high_value;
+    static constexpr int window_count = 10;
+    static constexpr unsigned window[window_count] =
+    {
+        StraightWindow(12), StraightWindow(11), StraightWindow(10), StraightWindow(9), StraightWindow(8),
+        StraightWindow(7), StraightWindow(6), StraightWindow(5), StraightWindow(4), (1u << 12) | 15u
+    };
+    static constexpr int window_top[window_count] = { 12, 11, 10, 9, 8, 7, 6, 5, 4, 3 };
+};
+
+
+struct sAceHighPolicy
+{   // the Ace only plays high, A 2 3 4 5 is Ace high nothing
+    static constexpr const char* name = "ace-high";
+    static constexpr bool lowball = false;
+    static constexpr bool flushes = true;
+    static constexpr bool royal   = true;
+    static constexpr const int* value = ace_high_value;
+    static constexpr int window_count = 9;
+    static constexpr unsigned window[window_count] =
+    {
+        StraightWindow(12), StraightWindow(11), StraightWindow(10), StraightWindow(9), StraightWindow(8),
+        StraightWindow(7), StraightWindow(6), StraightWindow(5), StraightWindow(4)
+    };
+    static constexpr int window_top[window_count] = { 12, 11, 10, 9, 8, 7, 6, 5, 4 };
+};
+
+
+struct sAceLowPolicy
+{   // the Ace only plays low, 9 10 J Q K suited is the best straight flush, no royal
+    static constexpr const char* name = "ace-low";
+    static constexpr bool lowball = false;
+    static constexpr bool flushes = true;
+    static constexpr bool royal   = false;
+    static constexpr const int* value = ace_low_value;
+    static constexpr int window_count = 9;
+    static constexpr unsigned window[window_count] =
+    {
+        StraightWindow(12), StraightWindow(11), StraightWindow(10), StraightWindow(9), StraightWindow(8),
+        StraightWindow(7), StraightWindow(6), StraightWindow(5), StraightWindow(4)
+    };
+    static constexpr int window_top[window_count] = { 12, 11, 10, 9, 8, 7, 6, 5, 4 };
+};
+
+
+struct sDeuceToSevenPolicy
+{   // lowball, the Ace is high and straights and flushes count against you. best is 7 5 4 3 2
+    static constexpr const char* name = "deuce-to-seven";
+    static constexpr bool lowball = true;
+    static constexpr bool flushes = true;
+    static constexpr bool royal   = true;
+    static constexpr const int* value = ace_high_value;
+    static constexpr int window_count = 9;
+    static constexpr unsigned window[window_count] =
+    {
+        StraightWindow(12), StraightWindow(11), StraightWindow(10), StraightWindow(9), StraightWindow(8),
+        StraightWindow(7), StraightWindow(6), StraightWindow(5), StraightWindow(4)
+    };
+    static constexpr int window_top[window_count] = { 12, 11, 10, 9, 8, 7, 6, 5, 4 };
+};
+
+
+struct sAceToFivePolicy
+{   // lowball, the Ace is low and straights and flushes do not count. best is 5 4 3 2 A
+    static constexpr const char* name = "ace-to-five";
+    static constexpr bool lowball = true;
+    static constexpr bool flushes = false;
+    static constexpr bool royal   = false;
+    static constexpr const int* value = ace_low_value;
+    static constexpr int window_count = 0;
+    static constexpr unsigned window[1] = { 0 };
+    static constexpr int window_top[1] = { 0 };
+};
+
+
+template <class Policy>
+static int StraightTop(unsigned mask)
+{   // top of the highest window holding every value of mask, -1 if none
+    for (int w = 0; w < Policy::window_count; w++)
+        if ((mask & ~Policy::window[w]) == 0) return Policy::window_top[w];
+    return -1;
+}
+
+
+static int GroupRank(const int count[13])
+{   // rank code of the value counts alone: pairs, trips, full house ...
+    int most = 0, pairs = 0;
+    for (int v = 0; v < 13; v++)
+    {
+        most = std::max(most, count[v]);
+        if (count[v] >= 2) pairs++;
+    }
+    if (most >= 5) return 28;
+    if (most == 4) return 24;
+    if (most == 3) return (pairs >= 2) ? 16 : 12;
+    if (pairs >= 2) return 8;
+    return (pairs == 1) ? 4 : 0;
+}
+
+
+static unsigned GroupKickers(const int count[13])
+{   // each value once, bigger groups first, then higher value, 4 bits each
+    unsigned by_count[6] = { 0 };                             // values seen exactly n times
+    for (int v = 0; v < 13; v++) by_count[std::min(count[v], 5)] |= 1u << v;
+    unsigned kickers = 0;
+    int pushed = 0;
+    for (int n = 5; n > 0; n--)
+        for (unsigned m = by_count[n]; m; m &= ~(1u << TopValue(m))) { kickers = (kickers << 4) | (unsigned)TopValue(m); pushed++; }
+    while (pushed < 5) { kickers <<= 4; pushed++; }
+    return kickers;
+}
+
+
+template <class Policy>
+static unsigned PolicyStrength(const int cards[5])
+{   // comparable key for Policy, bigger wins
+    int count[13] = { 0 };
+    unsigned mask = 0;
+    unsigned suits = 0;
+    int jokers = 0;
+    int top = -1;                                            // value * 4 + suit of the highest natural card
+    for (int i = 0; i < 5; i++)
+    {
+        int card = cards[i];
+        if (IsJoker(card)) { jokers++; continue; }
+        int v = Policy::value[card % 13];
+        count[v]++;
+        mask |= 1u << v;
+        suits |= 1u << CardSuit(card);
+        top = std::max(top, v * 4 + CardSuit(card));
+    }
+    const unsigned suit = (top >= 0) ? (unsigned)(top & 3) : 0u;
+    int most = 0;
+    for (int v = 0; v < 13; v++) most = std::max(most, count[v]);
+    bool distinct = most <= 1;
+
+    if constexpr (Policy::lowball)
+    {   // jokers take the lowest missing values, and bump past a straight
+        unsigned joker_mask = 0;
+        for (int v = 0, j = jokers; v < 13 && j > 0; v++)
+            if (!(mask & (1u << v))) { joker_mask |= 1u << v; j--; }
+        if constexpr (Policy::window_count > 0)
+        {
+            while (joker_mask && distinct && StraightTop<Policy>(mask | joker_mask) >= 0)
+            {   // the highest joker moves just above the current top card
+                int top = TopValue(mask | joker_mask);
+                if (top >= 12) break;
+                joker_mask &= ~(1u << TopValue(joker_mask));
+                joker_mask |= 1u << (top + 1);
+            }
+        }
+        for (int v = 0; v < 13; v++)
+            if (joker_mask & (1u << v)) count[v]++;
+
+        int rank = GroupRank(count);
+        bool flush = Policy::flushes && jokers == 0 && (suits & (suits - 1)) == 0;
+        int straight = distinct ? StraightTop<Policy>(mask | joker_mask) : -1;
+        if (straight >= 0 && flush) rank = (Policy::royal && straight == 12) ? 30 : 29;
+        else if (flush && rank < 16) rank = 15;
+        else if (straight >= 0) rank = 14;
+        return ((unsigned)(30 - rank) << 22) | ((~GroupKickers(count) & 0xFFFFFu) << 2) | suit;
+    }
+    else
+    {
+        // grouped hands: jokers join the leading group, all jokers are five of the top value
+        int grouped[13];
+        std::copy(count, count + 13, grouped);
+        int lead = 12;
+        for (int v = 12; v >= 0; v--)
+            if (count[v] == most && most > 0) { lead = v; break; }
+        grouped[lead] += jokers;
+        unsigned best = ((unsigned)GroupRank(grouped) << 22) | (GroupKickers(grouped) << 2);
+
+        bool one_suit = Policy::flushes && (suits & (suits - 1)) == 0;     // jokers follow the suit
+        if constexpr (Policy::window_count > 0)
+        {
+            int straight = distinct ? StraightTop<Policy>(mask) : -1;
+            if (straight >= 0)
+            {   // a royal has no kicker, they all tie
+                int rank = one_suit ? ((Policy::royal && straight == 12) ? 30 : 29) : 14;
+                best = std::max(best, ((unsigned)rank << 22) | ((rank == 30) ? 0u : (unsigned)straight << 18));
+            }
+        }
+        if (one_suit)
+        {   // jokers become the highest cards missing from the suit
+            int flush[13];
+            std::copy(count, count + 13, flush);
+            for (int v = 12, j = jokers; v >= 0 && j > 0; v--)
+                if (!flush[v]) { flush[v] = 1; j--; }
+            unsigned kickers = 0;
+            int pushed = 0;
+            for (int v = 12; v >= 0; v--)
+                if (flush[v]) { kickers = (kickers << 4) | (unsigned)v; pushed++; }
+            while (pushed < 5) { kickers <<= 4; pushed++; }
+            best = std::max(best, (15u << 22) | (kickers << 2));
+        }
+        return best | suit;
+    }
+}
+
+
+template <class Policy>
+static int PolicyRank(unsigned key)
+{   // rank code of PokerHandName back from a PolicyStrength() key
+    int code = (int)(key >> 22);
+    return Policy::lowball ? 30 - code : code;
+}
+
+
+template <class Policy>
+static void PolicyStrengths(const int (*cards)[5], int count, unsigned* key)
+{   // batch form for RankShowdown(), one instantiation per policy
+    for (int lane = 0; lane < count; lane++) key[lane] = PolicyStrength<Policy>(cards[lane]);
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include "poker_hand.h"
+#include "poker_policy.h"
+
+/*
+    Reference evaluator, slow on purpose: every joker is replaced by every one of the
+    52 standard cards and the best natural rank wins. No joker rules at all, so it is
+    the yardstick for RankHand() and any faster evaluator (see poker_verify.cpp).
+
+    Jokers are interchangeable, so substitutions are tried as non-decreasing card
+    sequences instead of every ordering. Same answer, a fraction of the work.
+
+    PolicyReferenceRank() does the same for a ranking policy from poker_policy.h, only its
+    value and window tables are shared, the best substitution is the highest rank code
+    (the lowest for lowball).
+*/
+
+static int NaturalRank(const int cards[5])
+{   // five standard cards (repeats allowed) => rank code of PokerHandName
+    int count[13] = { 0 };
+    int suits = 0;
+    for (int i = 0; i < 5; i++)
+    {
+        count[CardValue(cards[i])]++;
+        suits |= 1 << CardSuit(cards[i]);
+    }
+
+    int most = 0, pairs = 0, present = 0;
+    for (int v = 0; v < 13; v++)
+    {
+        most = std::max(most, count[v]);
+        if (count[v] >= 2) pairs++;
+        if (count[v]) present |= 1 << v;
+    }
+    bool flush = (suits & (suits - 1)) == 0;
+
+    int high = -1;                                                         // top value of a straight
+    if (most == 1)
+    {
+        for (int t = 12; t >= 4 && high < 0; t--)
+            if (((present >> (t - 4)) & 31) == 31) high = t;
+        if (high < 0 && present == ((1 << 12) | 15)) high = 3;             // A 2 3 4 5
+    }
+
+    if (high >= 0 && flush) return (high == 12) ? 30 : 29;
+    if (most == 5) return 28;
+    if (most == 4) return 24;
+    if (most == 3 && pairs == 2) return 16;
+    if (flush) return 15;
+    if (high >= 0) return 14;
+    if (most == 3) return 12;
+    if (pairs == 2) return 8;
+    if (pairs == 1) return 4;
+    return 0;
+}
+
+
+static int ReferenceRank(const int cards[5])
+{
+    int naturals[5];
+    int n = 0;
+    for (int i = 0; i < 5; i++)
+        if (!IsJoker(cards[i])) naturals[n++] = cards[i];
+    int jokers = 5 - n;
+
+    int hand[5];
+    std::copy(naturals, naturals + n, hand);
+    if (jokers == 0) return NaturalRank(hand);
+
+    int pick[5] = { 1, 1, 1, 1, 1 };                                       // substitution for each joker
+    int best = 0;
+    for (;;)
+    {
+        for (int j = 0; j < jokers; j++) hand[n + j] = pick[j];
+        best = std::max(best, NaturalRank(hand));
+        if (best == 30) return best;
+
+        int j = jokers - 1;                                                // next non-decreasing sequence
+        while (j >= 0 && pick[j] == 52) j--;
+        if (j < 0) return best;
+        pick[j]++;
+        for (int k = j + 1; k < jokers; k++) pick[k] = pick[j];
+    }
+}
+
+
+template <class Policy>
+static int PolicyNaturalRank(const int cards[5])
+{   // five standard cards (repeats allowed) => rank code under Policy
+    int count[13] = { 0 };
+    int suits = 0;
+    unsigned present = 0;
+    for (int i = 0; i < 5; i++)
+    {
+        int v = Policy::value[cards[i] % 13];
+        count[v]++;
+        present |= 1u << v;
+        suits |= 1 << CardSuit(cards[i]);
+    }
+
+    int most = 0, pairs = 0;
+    for (int v = 0; v < 13; v++)
+    {
+        most = std::max(most, count[v]);
+        if (count[v] >= 2) pairs++;
+    }
+    bool flush = Policy::flushes && (suits & (suits - 1)) == 0;
+
+    int high = -1;                                                         // top value of a straight
+    for (int w = 0; w < Policy::window_count && most == 1 && high < 0; w++)
+        if (present == Policy::window[w]) high = Policy::window_top[w];
+
+    if (high >= 0 && flush) return (Policy::royal && high == 12) ? 30 : 29;
+    if (most == 5) return 28;
+    if (most == 4) return 24;
+    if (most == 3 && pairs == 2) return 16;
+    if (flush) return 15;
+    if (high >= 0) return 14;
+    if (most == 3) return 12;
+    if (pairs == 2) return 8;
+    if (pairs == 1) return 4;
+    return 0;
+}
+
+
+template <class Policy>
+static int PolicyReferenceRank(const int cards[5])
+{
+    int hand[5];
+    int n = 0;
+    for (int i = 0; i < 5; i++)
+        if (!IsJoker(cards[i])) hand[n++] = cards[i];
+    int jokers = 5 - n;
+    if (jokers == 0) return PolicyNaturalRank<Policy>(hand);
+
+    const int ideal = Policy::lowball ? 0 : (Policy::royal ? 30 : 29);
+    int pick[5] = { 1, 1, 1, 1, 1 };
+    int best = -1;
+    for (;;)
+    {
+        for (int j = 0; j < jokers; j++) hand[n + j] = pick[j];
+        int rank = PolicyNaturalRank<Policy>(hand);
+        if (best < 0 || (Policy::lowball ? rank < best : rank > best)) best = rank;
+        if (best == ideal) return best;
+
+        int j = jokers - 1;
+        while (j >= 0 && pick[j] == 52) j--;
+        if (j < 0) return best;
+        pick[j]++;
+        for (int k = j + 1; k < jokers; k++) pick[k] = pick[j];
+    }
+}
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <random>
+#include <algorithm>
+#include <bitset>
+#include <type_traits>
+#include "poker_hand.h"
+#include "poker_policy.h"
+#include "poker_shoe.h"
+#include "poker_showdown.h"
+#include "poker_trace.h"
+
+/*
+    One full round of play split into phases:
+
+        Deal()  =>  Draw() / DealerDraw()  =>  Showdown()  =>  Payout()
+
+    The interactive loop in main() calls the phases one at a time between prompts,
+    PlayHeadless() runs them back to back for batch simulation.
+    Everything lives in fixed size members, nothing allocates once the round exists.
+
+    Every phase is an sTraceScope span, PlayHeadless() a whole round around them (poker_trace.h).
+
+    Without a shoe every Deal() shuffles the single joker deck. With one, the first
+    round_cards of deck_ids are the next cards of the shoe and only the cards a round used
+    are consumed, so the shoe's cut card decides when the next shoe comes in.
+
+    sPolicyRound<Policy> ranks, draws and settles the showdown under one ranking order
+    (poker_policy.h). sRound is the game's high order, where the key is HandStrength() itself
+    and RankHand() still sorts the cards the way the interactive game shows them.
+*/
+
+const int deal_shuffles = 7;                                   // std::shuffle passes per Deal() without a shoe, see poker_shuffle.cpp
+
+enum Seat { seat_dealer, seat_player1, seat_player2, seat_player3, seat_count };
+
+const int lowball_keep = 6;                                   // policy value a lowball draw keeps: an 8 with the Ace high, a 7 with it low
+
+const int round_cards = seat_count * 10;                       // a full table: five dealt and up to five drawn per seat
+
+static const char* const SeatName[seat_count] = { "Dealer", "Player 1", "Player", "Player 3" };
+
+
+template <class Policy>
+struct sPolicyRound
+{
+    int deck_ids[deck_size];                 // shuffled copy of joker_deck
+    unsigned deal_index = 0;                 // sequential iteration, a full table uses round_cards of deck_size
+    HandInfo hands[seat_count] = {};         // see Seat for the table positions
+    unsigned strength[seat_count] = {};      // Strength() of each seat after Showdown()
+    std::bitset<seat_count> seated;          // who plays this round
+    std::bitset<seat_count> winners;         // best hand(s) after Showdown(), more than one is a split pot
+    int chips[seat_count] = {};
+    int ante = 1;
+    std::mt19937 mte;
+    sShoe* shoe = nullptr;                   // multi-deck shoe, null => fresh single deck every round
+
+
+    sPolicyRound()
+    {
+        std::random_device rd;
+        Seed(rd());
+        seated.set(seat_dealer);
+        seated.set(seat_player2);
+    }
+
+
+    void Seed(unsigned seed)
+    {
+        mte.seed(seed);
+        std::copy(joker_deck, joker_deck + deck_size, deck_ids);
+    }
+
+
+    void Seed(std::seed_seq &seq)
+    {
+        mte.seed(seq);
+        std::copy(joker_deck, joker_deck + deck_size, deck_ids);
+    }
+
+
+    void Deal()
+    {
+        sTraceScope span(trace_deal);
+        if (shoe)
+        {
+            shoe->Consume((int)deal_index);
+            shoe->Window(deck_ids, round_cards);
+        }
+        else
+        {
+            for (int i = 0; i < deal_shuffles; i++)
+                std::shuffle(deck_ids, deck_ids + deck_size, mte);
+        }
+        deal_index = 0;
+
+        for (int i = 0; i < 5; ++i)
+        {   // players in seat order, the dealer takes the last card of each pass
+            for (int s = seat_player1; s < seat_count; s++)
+                if (seated[s]) hands[s].cards[i] = deck_ids[deal_index++];
+            hands[seat_dealer].cards[i] = deck_ids[deal_index++];
+        }
+
+        for (HandInfo &hand : hands)
+        {
+            hand.high_card = 0;
+            hand.rank = 0;
+            hand.jokers.reset();
+        }
+        winners.reset();
+    }
+
+
+    void Draw(int seat, std::bitset<5> hold)
+    {   // replace every card not held, positions as last displayed (RankHand sorts)
+        sTraceScope span(trace_draw);
+        for (int i = 0; i < 5; i++)
+            if (!hold[i]) hands[seat].cards[i] = deck_ids[deal_index++];
+        Rank(hands[seat]);
+    }
+
+
+    static void Rank(HandInfo &hand)
+    {   // rank code only, what the draw rules look at
+        if constexpr (std::is_same<Policy, sHighPolicy>::value) RankHand(hand);
+        else hand.rank = PolicyRank<Policy>(PolicyStrength<Policy>(hand.cards));
+    }
+
+
+    static unsigned Strength(HandInfo &hand)
+    {   // rank code into hand.rank, returns the showdown key, bigger wins
+        if constexpr (std::is_same<Policy, sHighPolicy>::value)
+        {
+            RankHand(hand);
+            return HandStrength(hand);
+        }
+        else
+        {
+            unsigned key = PolicyStrength<Policy>(hand.cards);
+            hand.rank = PolicyRank<Policy>(key);
+            return key;
+        }
+    }
+
+
+    static std::bitset<5> DrawPolicy(const HandInfo &hand)
+    {   // house rule: stand on a straight or better, keep jokers and matched cards,
+        // otherwise chase four to a flush or keep the highest card
+        if constexpr (Policy::lowball) return LowballDrawPolicy(hand);
+        std::bitset<5> hold;
+        if (hand.rank >= 14) { hold.set(); return hold; }
+
+        int count[13] = { 0 };
+        int suit_count[4] = { 0 };
+        int jokers = 0;
+        for (int card : hand.cards)
+        {
+            if (IsJoker(card)) { jokers++; continue; }
+            count[Value(card)]++;
+            suit_count[CardSuit(card)]++;
+        }
+
+        for (int i = 0; i < 5; i++)
+            if (IsJoker(hand.cards[i]) || count[Value(hand.cards[i])] > 1) hold.set(i);
+        if ((int)hold.count() > jokers) return hold;                  // matched cards found
+
+        for (int s = 0; s < 4; s++)
+        {
+            if (suit_count[s] + jokers < 4) continue;
+            for (int i = 0; i < 5; i++)
+                if (!IsJoker(hand.cards[i]) && CardSuit(hand.cards[i]) == s) hold.set(i);
+            return hold;
+        }
+
+        int best = -1;
+        for (int i = 0; i < 5; i++)
+        {
+            if (IsJoker(hand.cards[i])) continue;
+            if (best < 0 || Value(hand.cards[i]) > Value(hand.cards[best])) best = i;
+        }
+        if (best >= 0) hold.set(best);
+        return hold;
+    }
+
+
+    static int Value(int card) { return Policy::value[card % 13]; }
+
+
+    static std::bitset<5> LowballDrawPolicy(const HandInfo &hand)
+    {   // lowball house rule: keep jokers and one card of every value up to lowball_keep,
+        // break a made straight or flush by throwing its highest card
+        std::bitset<5> hold;
+        bool seen[13] = {};
+        for (int i = 0; i < 5; i++)
+        {
+            if (IsJoker(hand.cards[i])) { hold.set(i); continue; }
+            int v = Value(hand.cards[i]);
+            if (v <= lowball_keep && !seen[v]) { seen[v] = true; hold.set(i); }
+        }
+        if (hold.all() && hand.rank != 0)
+        {
+            int worst = -1;
+            for (int i = 0; i < 5; i++)
+                if (!IsJoker(hand.cards[i]) && (worst < 0 || Value(hand.cards[i]) > Value(hand.cards[worst]))) worst = i;
+            if (worst >= 0) hold.reset(worst);
+        }
+        return hold;
+    }
+
+
+    void DealerDraw()
+    {
+        sTraceScope span(trace_dealer_draw);
+        Rank(hands[seat_dealer]);
+        Draw(seat_dealer, DrawPolicy(hands[seat_dealer]));
+    }
+
+
+    void Showdown()
+    {   // rank every seated hand, the first tie group wins, more than one hand in it splits
+        sTraceScope span(trace_showdown);
+        unsigned key[seat_count];
+        int seat_of[seat_count];
+        int n = 0;
+        for (int s = 0; s < seat_count; s++)
+        {
+            if (!seated[s]) continue;
+            strength[s] = Strength(hands[s]);
+            key[n] = strength[s];
+            seat_of[n++] = s;
+        }
+        int order[seat_count], group[seat_count], scratch[seat_count];
+        RankShowdown(key, n, order, group, scratch);
+        winners.reset();
+        for (int i = 0; i < n && group[i] == 0; i++) winners.set(seat_of[order[i]]);
+    }
+
+
+    void Payout()
+    {   // every seat antes, the winners split the pot, odd chips go in seat order
+        sTraceScope span(trace_payout);
+        int pot = 0;
+        for (int s = 0; s < seat_count; s++)
+            if (seated[s]) { chips[s] -= ante; pot += ante; }
+
+        int share = pot / (int)winners.count();
+        int odd = pot % (int)winners.count();
+        for (int s = 0; s < seat_count; s++)
+        {
+            if (!winners[s]) continue;
+            chips[s] += share;
+            if (odd > 0) { chips[s]++; odd--; }
+        }
+    }
+
+
+    void PlayHeadless()
+    {   // every player seat uses the same draw rule as the dealer
+        sTraceScope span(trace_round);
+        Deal();
+        for (int s = seat_player1; s < seat_count; s++)
+        {
+            if (!seated[s]) continue;
+            {
+                sTraceScope rank(trace_rank);
+                Rank(hands[s]);
+            }
+            Draw(s, DrawPolicy(hands[s]));
+        }
+        DealerDraw();
+        Showdown();
+        Payout();
+    }
+
+};
+
+typedef sPolicyRound<sHighPolicy> sRound;
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <random>
+#include <thread>
+#include <chrono>
+#include "poker_round.h"
+
+#ifdef _WIN32
+#define shard_popen  _popen
+#define shard_pclose _pclose
+#else
+#define shard_popen  popen
+#define shard_pclose pclose
+#endif
+
+/*
+    Sharded simulation: one run of headless rounds spread over worker processes.
+
+    A run is cut into blocks of block_rounds rounds. Block b is a fresh table (all four seats,
+    chips at 0) seeded from seed_seq{ seed, b }, so what a block plays depends on the run's
+    seed and its own number and on nothing else. A shard is a range of blocks. Everything a
+    shard reports is an integer sum (rank histogram, wins, split pots, chip deltas and their
+    squares for the EV), sums merge in any order, so the merged result and its Digest() are
+    bit-identical for any shard count, process count or retry.
+
+    The coordinator starts poker -shard ... per shard with popen(), at most processes at a
+    time, and reads one line back over the pipe. The line ends in a hash of its own fields;
+    a worker that exits non-zero, writes a short or damaged line or reports another block
+    range has failed and the same shard is started again, up to max_shard_attempts.
+    processes 0 plays the shards in the coordinator instead, same numbers.
+
+    Collect() blocks on the pipe until the worker closes it, so a hung worker has to end
+    itself: every worker is started with a deadline in seconds (Deadline(), or the one given
+    to -shards) and a watchdog thread that _Exit()s the process with an error once it passes.
+    The pipe closes, the attempt counts as failed and the shard is rerun like any other
+    failure. A worker whose watchdog can not run either (the whole process stopped or
+    frozen by the system) is out of scope, the coordinator then waits on it.
+
+    POKER_SHARD_FAIL=<shard> in the environment makes that shard's first attempt exit with
+    an error, POKER_SHARD_HANG=<shard> makes it hang until its deadline, to watch a retry.
+*/
+
+const int default_block_rounds = 10000;
+const int max_shard_attempts   = 3;
+const int shard_grace_seconds  = 30;             // deadline of every attempt on top of its rounds
+const int shard_rounds_per_second = 1000;        // a small fraction of what one core plays
+
+
+inline void StartShardWatchdog(int seconds)
+{   // worker side: past the deadline the process ends with exit code 4, wherever it is stuck
+    if (seconds <= 0) return;
+    std::thread([seconds]
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        std::fflush(nullptr);
+        std::_Exit(4);
+    }).detach();
+}
+
+
+struct sShardResult
+{
+    long long first_block = 0;
+    long long blocks = 0;
+    long long rounds = 0;
+    long long category[31] = {};                 // final rank of every seated hand
+    long long wins[seat_count] = {};             // pots won alone
+    long long splits[seat_count] = {};           // pots shared
+    long long net[seat_count] = {};              // sum of chip deltas per round
+    long long net_squares[seat_count] = {};      // sum of their squares
+
+
+    void Merge(const sShardResult &other)
+    {   // any order, the sums do not care
+        first_block = blocks ? std::min(first_block, other.first_block) : other.first_block;
+        blocks += other.blocks;
+        rounds += other.rounds;
+        for (int r = 0; r < 31; r++) category[r] += other.category[r];
+        for (int s = 0; s < seat_count; s++)
+        {
+            wins[s] += other.wins[s];
+            splits[s] += other.splits[s];
+            net[s] += other.net[s];
+            net_squares[s] += other.net_squares[s];
+        }
+    }
+
+
+    std::vector<long long> Fields() const
+    {   // wire and digest order
+        std::vector<long long> f = { first_block, blocks, rounds };
+        f.insert(f.end(), category, category + 31);
+        f.insert(f.end(), wins, wins + seat_count);
+        f.insert(f.end(), splits, splits + seat_count);
+        f.insert(f.end(), net, net + seat_count);
+        f.insert(f.end(), net_squares, net_squares + seat_count);
+        return f;
+    }
+
+
+    static unsigned long long Hash(const std::vector<long long> &fields)
+    {   // FNV-1a over the little endian bytes
+        unsigned long long h = 14695981039346656037ull;
+        for (long long v : fields)
+            for (int b = 0; b < 8; b++)
+            {
+                h ^= ((unsigned long long)v >> (8 * b)) & 0xFF;
+                h *= 1099511628211ull;
+            }
+        return h;
+    }
+
+
+    unsigned long long Digest() const { return Hash(Fields()); }
+
+
+    std::string Line() const
+    {   // shard <fields...> <hash>
+        std::ostringstream line;
+        line << "shard";
+        std::vector<long long> f = Fields();
+        for (long long v : f) line << " " << v;
+        line << " " << Hash(f) << "\n";
+        return line.str();
+    }
+
+
+    bool Parse(const std::string &text)
+    {   // false on anything but one complete, intact line
+        std::istringstream in(text);
+        std::string tag;
+        if (!(in >> tag) || tag != "shard") return false;
+        std::vector<long long> f(3 + 31 + 4 * seat_count);
+        for (long long &v : f)
+            if (!(in >> v)) return false;
+        unsigned long long hash = 0;
+        if (!(in >> hash) || hash != Hash(f)) return false;
+
+        size_t i = 0;
+        first_block = f[i++];
+        blocks = f[i++];
+        rounds = f[i++];
+        for (long long &v : category) v = f[i++];
+        for (long long &v : wins) v = f[i++];
+        for (long long &v : splits) v = f[i++];
+        for (long long &v : net) v = f[i++];
+        for (long long &v : net_squares) v = f[i++];
+        return true;
+    }
+};
+
+
+struct sShardPlan
+{   // the run, shared by the coordinator and every worker
+    long long rounds = 0;
+    unsigned seed = 1;
+    int block_rounds = default_block_rounds;
+
+
+    long long Blocks() const { return (rounds + block_rounds - 1) / block_rounds; }
+
+
+    sShardResult Play(long long first_block, long long block_count) const
+    {   // blocks [first_block, first_block + block_count) of the run
+        sRound table;                            // every block reseeds it, nothing carries over between calls
+        sShardResult result;
+        result.first_block = first_block;
+        for (long long b = first_block; b < first_block + block_count && b < Blocks(); b++)
+        {
+            std::seed_seq seq{ seed, (unsigned)b, (unsigned)(b >> 32) };
+            table.Seed(seq);
+            table.seated.set();
+            for (int &c : table.chips) c = 0;
+            long long rounds_here = std::min<long long>(block_rounds, rounds - b * block_rounds);
+            for (long long r = 0; r < rounds_here; r++)
+            {
+                int before[seat_count];
+                std::copy(table.chips, table.chips + seat_count, before);
+                table.PlayHeadless();
+                bool split = table.winners.count() > 1;
+                for (int s = 0; s < seat_count; s++)
+                {
+                    result.category[table.hands[s].rank]++;
+                    if (table.winners[s]) (split ? result.splits : result.wins)[s]++;
+                    long long delta = table.chips[s] - before[s];
+                    result.net[s] += delta;
+                    result.net_squares[s] += delta * delta;
+                }
+            }
+            result.blocks++;
+            result.rounds += rounds_here;
+        }
+        return result;
+    }
+};
+
+
+struct sShardCoordinator
+{
+    struct sShard
+    {
+        long long first_block = 0;
+        long long blocks = 0;
+        int attempts = 0;
+        FILE* pipe = nullptr;
+    };
+
+    std::string exe;                             // this program, workers are started as exe -shard ...
+    sShardPlan plan;
+    int deadline_seconds = 0;                    // per attempt, 0 => Deadline() of the shard's rounds
+    std::vector<sShard> shards;
+    long long failures = 0;                      // attempts that had to be repeated
+    std::string error;
+
+
+    void Split(int shard_count)
+    {   // contiguous block ranges, as even as the blocks allow
+        long long blocks = plan.Blocks();
+        shard_count = (int)std::max(1LL, std::min<long long>(shard_count, blocks));
+        shards.assign(shard_count, sShard());
+        for (int i = 0; i < shard_count; i++)
+        {
+            shards[i].first_block = blocks * i / shard_count;
+            shards[i].blocks = blocks * (i + 1) / shard_count - shards[i].first_block;
+        }
+    }
+
+
+    int Deadline(int i) const
+    {   // seconds an attempt of shard i may take before its watchdog ends it
+        if (deadline_seconds > 0) return deadline_seconds;
+        long long rounds = shards[i].blocks * plan.block_rounds;
+        return shard_grace_seconds + (int)std::min<long long>(rounds / shard_rounds_per_second, 24 * 3600);
+    }
+
+
+    std::string Command(int i) const
+    {
+        const sShard &s = shards[i];
+        return "\"" + exe + "\" -shard " + std::to_string(plan.rounds) + " " + std::to_string(plan.seed) + " "
+             + std::to_string(plan.block_rounds) + " " + std::to_string(s.first_block) + " " + std::to_string(s.blocks)
+             + " " + std::to_string(i) + " " + std::to_string(s.attempts) + " " + std::to_string(Deadline(i));
+    }
+
+
+    bool Start(int i)
+    {
+        sShard &s = shards[i];
+        std::string command = Command(i);        // attempt number is the attempts made so far
+        s.attempts++;
+        std::fflush(nullptr);                    // the child must not inherit unwritten output
+        s.pipe = shard_popen(command.c_str(), "r");
+        return s.pipe != nullptr;
+    }
+
+
+    bool Collect(int i, sShardResult &result)
+    {   // whole output, then the exit status. false => the attempt failed
+        sShard &s = shards[i];
+        std::string text;
+        char buffer[1024];
+        size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), s.pipe)) > 0) text.append(buffer, n);
+        int status = shard_pclose(s.pipe);
+        s.pipe = nullptr;
+        return status == 0 && result.Parse(text) && result.first_block == s.first_block && result.blocks == s.blocks;
+    }
+
+
+    bool Run(int shard_count, int processes, sShardResult &total)
+    {   // false with error set once a shard has failed max_shard_attempts times
+        Split(shard_count);
+        total = sShardResult();
+        failures = 0;
+        if (processes <= 0)
+        {
+            for (const sShard &s : shards) total.Merge(plan.Play(s.first_block, s.blocks));
+            return true;
+        }
+
+        std::deque<int> queue, running;
+        for (int i = 0; i < (int)shards.size(); i++) queue.push_back(i);
+        while (!queue.empty() || !running.empty())
+        {
+            while (!queue.empty() && (int)running.size() < processes)
+            {
+                int i = queue.front();
+                queue.pop_front();
+                if (!Start(i))
+                {
+                    error = "can not start " + Command(i);
+                    return Abandon(running);
+                }
+                running.push_back(i);
+            }
+            int i = running.front();                 // oldest first, the others keep running meanwhile
+            running.pop_front();
+            sShardResult result;
+            if (Collect(i, result))
+            {
+                total.Merge(result);
+                continue;
+            }
+            failures++;
+            if (shards[i].attempts >= max_shard_attempts)
+            {
+                error = "shard " + std::to_string(i) + " failed " + std::to_string(max_shard_attempts) + " times";
+                return Abandon(running);
+            }
+            queue.push_front(i);                     // same blocks, same seeds, same result
+        }
+        return true;
+    }
+
+
+    bool Abandon(std::deque<int> &running)
+    {   // wait out the workers already started
+        for (int i : running)
+        {
+            sShardResult ignored;
+            Collect(i, ignored);
+        }
+        running.clear();
+        return false;
+    }
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "poker_hand.h"
+#include "poker_trace.h"
+
+/*
+    Shoe of 1 => 8 joker decks with a cut card.
+
+    A ring of shoe_buffers card buffers: the worker thread fills and shuffles shoe k into
+    buffer k % shoe_buffers as soon as the dealer has moved past shoe k - shoe_buffers, the
+    dealer moves on to shoe k + 1 once it is published. Both sides only read the other's
+    atomic counter, so dealing never takes a lock or waits on a shuffle while the worker
+    stays ahead. The cards behind the cut card are the reserve if it falls behind, only a
+    shoe dealt to the very end is reshuffled in place (counted in late_shuffles).
+
+    Window() hands out the next cards without consuming them, Consume() then advances by
+    what the round actually used. The next shoe comes in at the cut card, or earlier when
+    fewer than the window are left (a one deck shoe holds about one full table's round).
+    Nothing is read past the end of the buffer.
+*/
+
+const int max_shoe_decks = 8;
+const int max_shoe_cards = max_shoe_decks * deck_size;
+const int shoe_buffers   = 4;                                  // shoes the worker can shuffle ahead
+
+
+struct sShoe
+{
+    struct sCards
+    {
+        int cards[max_shoe_cards];
+    };
+
+    int decks = 1;
+    int size = deck_size;
+    int cut = deck_size * 3 / 4;             // cards dealt before the next shoe is brought in
+    int position = 0;
+    long long dealing = 0;                   // shoe number being dealt, dealer side
+    sCards buffer[shoe_buffers];
+    std::atomic<long long> filled{ 0 };      // shoes shuffled and published by the worker
+    std::atomic<long long> released{ 0 };    // shoes the dealer is done with
+    std::atomic<bool> stop{ false };
+    std::thread worker;
+    std::mutex sleep_lock;                   // worker side only, the dealer just notifies
+    std::condition_variable wake;
+    std::mt19937 mte;                        // worker owned once Begin() returns
+    std::mt19937 mte_late{ 0x5eed };         // dealer side, only for late_shuffles
+    long long late_shuffles = 0;
+
+
+    ~sShoe() { End(); }
+
+
+    void Begin(int deck_count, int cut_card, unsigned seed)
+    {   // cut_card <= 0 puts it three quarters in
+        End();
+        decks = std::max(1, std::min(max_shoe_decks, deck_count));
+        size = decks * deck_size;
+        cut = (cut_card > 0) ? std::min(cut_card, size) : size * 3 / 4;
+        mte.seed(seed);
+
+        Fill(buffer[0]);
+        filled = 1;
+        released = 0;
+        dealing = 0;
+        position = 0;
+        stop = false;
+        worker = std::thread([this] { Run(); });
+    }
+
+
+    void End()
+    {
+        stop = true;
+        wake.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+
+
+    void Fill(sCards &shoe)
+    {   // one Fisher-Yates pass over all decks
+        for (int d = 0; d < decks; d++)
+            std::copy(joker_deck, joker_deck + deck_size, shoe.cards + d * deck_size);
+        std::shuffle(shoe.cards, shoe.cards + size, mte);
+    }
+
+
+    void Run()
+    {
+        trace.Name("shoe worker");
+        while (!stop)
+        {
+            long long next = filled.load(std::memory_order_relaxed);
+            if (next >= released.load(std::memory_order_acquire) + shoe_buffers)
+            {   // ring is full. timed wait, a notify that lands before the wait only costs a millisecond
+                std::unique_lock<std::mutex> lock(sleep_lock);
+                wake.wait_for(lock, std::chrono::milliseconds(1));
+                continue;
+            }
+            {
+                sTraceScope span(trace_shuffle);
+                Fill(buffer[next % shoe_buffers]);
+            }
+            filled.store(next + 1, std::memory_order_release);
+        }
+    }
+
+
+    sCards &Current() { return buffer[dealing % shoe_buffers]; }
+
+
+    void Window(int* out, int count)
+    {   // next count cards, count <= deck_size
+        if (position >= cut || size - position < count)
+        {
+            if (filled.load(std::memory_order_acquire) > dealing + 1)
+            {
+                dealing++;
+                released.store(dealing, std::memory_order_release);
+                wake.notify_one();
+                position = 0;
+            }
+            else if (size - position < count)
+            {   // worker is behind and the reserve is gone
+                std::shuffle(Current().cards, Current().cards + size, mte_late);
+                position = 0;
+                late_shuffles++;
+            }
+        }
+        std::copy(Current().cards + position, Current().cards + position + count, out);
+    }
+
+
+    void Consume(int count) { position = std::min(size, position + count); }
+
+
+    int Remaining() const { return size - position; }
+
+};
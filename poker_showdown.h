@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+
+/*
+    Showdown ordering for any number of hands.
+
+    RankShowdown() takes HandStrength() keys and writes the seats strongest first,
+    plus the tie group of each position (0 = the winners, equal keys share a group).
+    Equal keys keep their seat order so results are deterministic.
+
+    A table (up to small_showdown hands) uses an insertion sort, it is all in registers.
+    Large fields use an LSD radix sort, three 9 bit passes cover the 27 bit key, so the
+    cost is linear in the field size. Caller owns every buffer, nothing allocates.
+*/
+
+const int small_showdown  = 32;
+const int showdown_bits   = 27;                                // HandStrength() key width
+const int showdown_digit  = 9;
+const int showdown_bucket = 1 << showdown_digit;
+
+
+static int RankShowdown(const unsigned* strength, int count, int* order, int* group, int* scratch)
+{   // order, group and scratch hold count ints. returns the number of tie groups
+    if (count <= 0) return 0;
+
+    if (count <= small_showdown)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            int seat = i;
+            int j = i;
+            while (j > 0 && strength[order[j - 1]] < strength[seat]) { order[j] = order[j - 1]; j--; }
+            order[j] = seat;
+        }
+    }
+    else
+    {   // descending by sorting the complemented key ascending
+        const unsigned key_mask = (1u << showdown_bits) - 1;
+        int* from = order;
+        int* to = scratch;
+        for (int i = 0; i < count; i++) from[i] = i;
+        for (int shift = 0; shift < showdown_bits; shift += showdown_digit)
+        {
+            int start[showdown_bucket] = { 0 };
+            for (int i = 0; i < count; i++) start[((~strength[i] & key_mask) >> shift) & (showdown_bucket - 1)]++;
+            for (int b = 0, sum = 0; b < showdown_bucket; b++) { int n = start[b]; start[b] = sum; sum += n; }
+            for (int i = 0; i < count; i++)
+            {
+                int seat = from[i];
+                to[start[((~strength[seat] & key_mask) >> shift) & (showdown_bucket - 1)]++] = seat;
+            }
+            std::swap(from, to);
+        }
+        if (from != order) std::copy(from, from + count, order);
+    }
+
+    int groups = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (i > 0 && strength[order[i]] != strength[order[i - 1]]) groups++;
+        group[i] = groups;
+    }
+    return groups + 1;
+}
@@ -0,0 +1,290 @@
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "poker_round.h"
+#include "poker_batch.h"
+
+/*
+    Shuffle harness: is the deck Deal() hands out uniform, and what does each way of shuffling cost.
+
+    Every strategy keeps one deck per thread and shuffles it in place passes times per deal,
+    the way sRound::Deal() does, so a weak pass carries over into the next deal. Per strategy:
+
+        position x card     every card equally likely at every deck position, one chi-square
+                            over the whole 55 x 55 matrix
+        first ten cards     the cards of a heads-up deal: each position on its own, each pair of
+                            neighbouring positions (one card must not predict the next), and the
+                            rank of both hands against the exact C(55,5) distribution
+        deals/s             a separate run that only shuffles, no counting
+
+    p-values use the Wilson-Hilferty normal approximation, good to a few digits at these
+    degrees of freedom. A strategy is fair when no test is below alpha / tests.
+    Each thread seeds its engine from seed_seq{ seed, thread }, a run repeats for the same thread count.
+    std::default_random_engine is implementation defined (minstd_rand0 in libstdc++ and libc++).
+
+    poker_shuffle [deals] [threads] [seed]        default 10,000,000 deals per strategy,
+                                                  hundreds of millions show smaller biases
+*/
+
+const int first_cards = 10;                                  // a heads-up deal, see sRound::Deal()
+const double alpha = 0.001;
+
+
+struct sCounts
+{
+    long long position[deck_size][deck_size] = {};               // [position][card - 1]
+    long long pair[first_cards - 1][deck_size][deck_size] = {};  // [position][card - 1][next card - 1]
+    long long hand_rank[2][31] = {};                             // [first / second hand][rank]
+
+
+    void Add(const int deck[deck_size])
+    {
+        for (int p = 0; p < deck_size; p++) position[p][deck[p] - 1]++;
+        for (int p = 0; p + 1 < first_cards; p++) pair[p][deck[p] - 1][deck[p + 1] - 1]++;
+        for (int h = 0; h < 2; h++)
+        {   // cards alternate between the two seats
+            HandInfo hand = HandInfo();
+            for (int i = 0; i < 5; i++) hand.cards[i] = deck[i * 2 + h];
+            RankHand(hand);
+            hand_rank[h][hand.rank]++;
+        }
+    }
+
+
+    void Merge(const sCounts &other)
+    {
+        for (int p = 0; p < deck_size; p++)
+            for (int c = 0; c < deck_size; c++) position[p][c] += other.position[p][c];
+        for (int p = 0; p + 1 < first_cards; p++)
+            for (int a = 0; a < deck_size; a++)
+                for (int b = 0; b < deck_size; b++) pair[p][a][b] += other.pair[p][a][b];
+        for (int h = 0; h < 2; h++)
+            for (int r = 0; r < 31; r++) hand_rank[h][r] += other.hand_rank[h][r];
+    }
+};
+
+
+template <class Engine>
+static unsigned long long Deals(int passes, unsigned seed, int thread, long long deals, sCounts* counts)
+{   // counts == nullptr only shuffles, the checksum keeps that loop from being optimised away
+    std::seed_seq seq{ seed, (unsigned)thread };
+    Engine engine(seq);
+    int deck[deck_size];
+    std::copy(joker_deck, joker_deck + deck_size, deck);
+    unsigned long long sum = 0;
+    for (long long d = 0; d < deals; d++)
+    {
+        for (int p = 0; p < passes; p++) std::shuffle(deck, deck + deck_size, engine);
+        if (counts) counts->Add(deck);
+        else sum = sum * 31 + (unsigned)deck[0];
+    }
+    return sum;
+}
+
+
+typedef unsigned long long (*DealFn)(int passes, unsigned seed, int thread, long long deals, sCounts* counts);
+
+struct sStrategy
+{
+    const char* name;
+    int passes;
+    DealFn deal;
+};
+
+static const sStrategy strategies[] =
+{
+    { "3 x default_random_engine (main_iteration_02)", 3,             Deals<std::default_random_engine> },
+    { "7 x mt19937 (sRound::Deal)",                    deal_shuffles, Deals<std::mt19937> },
+    { "1 x default_random_engine",                     1,             Deals<std::default_random_engine> },
+    { "1 x mt19937",                                   1,             Deals<std::mt19937> },
+};
+const int deal_strategy = 1;                                 // the one sRound::Deal() uses, decides the exit code
+
+
+struct sTest
+{
+    double chi2 = 0.0;
+    double df = 0.0;
+    double p = 1.0;
+};
+
+
+static double ChiSquareP(double chi2, double df)
+{   // upper tail, Wilson-Hilferty: (chi2 / df)^(1/3) is close to normal
+    double mean = 1.0 - 2.0 / (9.0 * df);
+    double z = (std::cbrt(chi2 / df) - mean) / std::sqrt(2.0 / (9.0 * df));
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+
+static sTest ChiSquare(const long long* observed, const double* expected, int cells)
+{   // cells with an expected count under 5 are pooled into one
+    sTest test;
+    double pooled_observed = 0.0, pooled_expected = 0.0;
+    int bins = 0;
+    for (int i = 0; i < cells; i++)
+    {
+        if (expected[i] <= 0.0) continue;
+        if (expected[i] < 5.0) { pooled_observed += (double)observed[i]; pooled_expected += expected[i]; continue; }
+        double d = (double)observed[i] - expected[i];
+        test.chi2 += d * d / expected[i];
+        bins++;
+    }
+    if (pooled_expected > 0.0)
+    {
+        double d = pooled_observed - pooled_expected;
+        test.chi2 += d * d / pooled_expected;
+        bins++;
+    }
+    test.df = bins - 1;
+    test.p = (test.df > 0) ? ChiSquareP(test.chi2, test.df) : 1.0;
+    return test;
+}
+
+
+static void ExactHandRanks(double probability[31])
+{   // every hand of the joker deck, ranked with RankHands() one first card at a time
+    long long count[31] = { 0 };
+    long long total = 0;
+    std::vector<int> cards;
+    std::vector<int> rank;
+    for (int a = 1; a <= deck_size; a++)
+    {
+        cards.clear();
+        for (int b = a + 1; b <= deck_size; b++)
+            for (int c = b + 1; c <= deck_size; c++)
+                for (int d = c + 1; d <= deck_size; d++)
+                    for (int e = d + 1; e <= deck_size; e++)
+                    {
+                        const int hand[5] = { a, b, c, d, e };
+                        cards.insert(cards.end(), hand, hand + 5);
+                    }
+        int n = (int)cards.size() / 5;
+        rank.resize(n);
+        RankHands((const int(*)[5])cards.data(), n, rank.data());
+        for (int r : rank) count[r]++;
+        total += n;
+    }
+    for (int r = 0; r < 31; r++) probability[r] = (double)count[r] / (double)total;
+}
+
+
+template <typename Fn>
+static double RunThreads(int threads, long long deals, Fn fn)
+{   // fn(thread, deals for that thread), returns seconds
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++)
+    {
+        long long share = deals / threads + ((t < deals % threads) ? 1 : 0);
+        pool.emplace_back([&fn, t, share] { fn(t, share); });
+    }
+    for (std::thread &worker : pool) worker.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+int main(int argc, char* argv[])
+{
+    long long deals = (argc > 1) ? std::atoll(argv[1]) : 10000000;
+    int threads = (argc > 2) ? std::atoi(argv[2]) : (int)std::thread::hardware_concurrency();
+    unsigned seed = (argc > 3) ? (unsigned)std::strtoul(argv[3], nullptr, 10) : 1;
+    if (deals < 1) deals = 1;
+    if (threads < 1) threads = 1;
+    const long long timing_deals = std::min(deals, 4000000LL);
+    const int tests = 1 + first_cards + (first_cards - 1) + 2;
+    const double fail_below = alpha / tests;
+
+    double exact[31];
+    ExactHandRanks(exact);
+
+    std::cout << deals << " deals per strategy, " << threads << " threads, seed " << seed
+              << ", fair when every p >= " << fail_below << "\n";
+
+    int cheapest = -1;
+    double cheapest_rate = 0.0;
+    bool deal_fair = true;
+    const int strategy_count = (int)(sizeof(strategies) / sizeof(strategies[0]));
+    for (int s = 0; s < strategy_count; s++)
+    {
+        const sStrategy &strategy = strategies[s];
+        std::vector<unsigned long long> checksum(threads);
+        double timing = RunThreads(threads, timing_deals, [&](int t, long long n)
+        {
+            checksum[t] = strategy.deal(strategy.passes, seed, t, n, nullptr);
+        });
+        double rate = (double)timing_deals / timing;
+
+        std::vector<sCounts> counts(threads);
+        double seconds = RunThreads(threads, deals, [&](int t, long long n)
+        {
+            strategy.deal(strategy.passes, seed, t, n, &counts[t]);
+        });
+        for (int t = 1; t < threads; t++) counts[0].Merge(counts[t]);
+        const sCounts &total = counts[0];
+
+        // position x card and the first ten positions, every cell expects deals / deck_size
+        std::vector<double> expected(deck_size * deck_size, (double)deals / deck_size);
+        sTest matrix = ChiSquare(&total.position[0][0], expected.data(), deck_size * deck_size);
+        matrix.df = (deck_size - 1) * (deck_size - 1);      // rows and columns both sum to deals
+        matrix.p = ChiSquareP(matrix.chi2, matrix.df);
+        double worst = matrix.p;
+
+        sTest position_worst;
+        int position_at = 0;
+        for (int p = 0; p < first_cards; p++)
+        {
+            sTest test = ChiSquare(total.position[p], expected.data(), deck_size);
+            if (p == 0 || test.p < position_worst.p) { position_worst = test; position_at = p; }
+        }
+        worst = std::min(worst, position_worst.p);
+
+        // neighbouring positions, each ordered pair of different cards expects deals / (55 * 54)
+        for (int a = 0; a < deck_size; a++)
+            for (int b = 0; b < deck_size; b++)
+                expected[a * deck_size + b] = (a == b) ? 0.0 : (double)deals / (deck_size * (deck_size - 1));
+        sTest pair_worst;
+        int pair_at = 0;
+        for (int p = 0; p + 1 < first_cards; p++)
+        {
+            sTest test = ChiSquare(&total.pair[p][0][0], expected.data(), deck_size * deck_size);
+            if (p == 0 || test.p < pair_worst.p) { pair_worst = test; pair_at = p; }
+        }
+        worst = std::min(worst, pair_worst.p);
+
+        sTest hand[2];
+        double hand_expected[31];
+        for (int r = 0; r < 31; r++) hand_expected[r] = exact[r] * (double)deals;
+        for (int h = 0; h < 2; h++)
+        {
+            hand[h] = ChiSquare(total.hand_rank[h], hand_expected, 31);
+            worst = std::min(worst, hand[h].p);
+        }
+
+        bool fair = worst >= fail_below;
+        if (s == deal_strategy) deal_fair = fair;
+        if (fair && rate > cheapest_rate) { cheapest = s; cheapest_rate = rate; }
+
+        std::cout << std::fixed << std::setprecision(0)
+                  << "\n" << strategy.name << "\n"
+                  << "  " << rate << " deals/s, " << rate * strategy.passes << " shuffles/s ("
+                  << rate / threads << " deals/s per thread), counted run " << std::setprecision(1) << seconds << "s\n"
+                  << std::setprecision(4)
+                  << "  position x card   chi2 " << matrix.chi2 << "  df " << (int)matrix.df << "  p " << matrix.p << "\n"
+                  << "  first ten cards   worst p " << position_worst.p << " at position " << position_at << "\n"
+                  << "  neighbour pairs   worst p " << pair_worst.p << " at positions " << pair_at << "-" << pair_at + 1 << "\n"
+                  << "  heads-up hands    p " << hand[0].p << " / " << hand[1].p << "  (df " << (int)hand[0].df << ")\n"
+                  << "  => " << (fair ? "fair" : "NOT FAIR") << "\n";
+    }
+
+    std::cout << "\ncheapest fair strategy: " << (cheapest >= 0 ? strategies[cheapest].name : "none") << "\n";
+    return deal_fair ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include "poker_round.h"
+
+/*
+    Spectator feed: headless tables played on worker threads, sampled by a renderer that
+    never makes them wait.
+
+    Every table has a seqlock slot. The renderer raises the slot's wanted flag once per
+    frame, the worker tests it with one relaxed load after each round and only then copies
+    the round out: sequence goes odd, the fields are stored, sequence goes even. Read()
+    copies the fields between two loads of the sequence and reports a torn copy if a store
+    was in flight, the renderer then keeps the snapshot it had. Neither side ever waits on
+    the other and a table nobody asks about pays one load per round.
+
+    The fields are relaxed atomics so a copy racing a store is still defined behaviour,
+    the sequence is what tells the reader to throw it away. Slots are cache line aligned,
+    the rounds counters are what the renderer sums for rounds/s.
+*/
+
+const int max_spectator_tables = 16;
+
+
+struct sTableSnapshot
+{   // one finished round of one table, plain copy for the renderer
+    int cards[seat_count][5];
+    int rank[seat_count];
+    int chips[seat_count];
+    unsigned winners;                        // seat bits
+    long long round;                         // rounds the table had played
+};
+
+
+struct alignas(64) sSpectatorSlot
+{
+    std::atomic<unsigned> sequence{ 0 };     // odd while the worker stores, 0 => nothing published yet
+    std::atomic<bool> wanted{ false };       // set by the renderer, cleared by the worker's next store
+    std::atomic<long long> rounds{ 0 };      // worker side count, relaxed
+    std::atomic<int> cards[seat_count * 5];
+    std::atomic<int> rank[seat_count];
+    std::atomic<int> chips[seat_count];
+    std::atomic<unsigned> winners{ 0 };
+    std::atomic<long long> round{ 0 };
+};
+
+
+struct sSpectator
+{
+    int table_count = 0;
+    int workers = 0;
+    sRound table[max_spectator_tables];      // table t is only touched by worker t % workers
+    sSpectatorSlot slot[max_spectator_tables];
+    std::atomic<bool> stop{ false };
+    std::vector<std::thread> pool;
+
+
+    ~sSpectator() { End(); }
+
+
+    void Begin(int tables, int threads, unsigned seed)
+    {   // threads <= 0 uses every core, never more threads than tables
+        End();
+        table_count = std::max(1, std::min(max_spectator_tables, tables));
+        if (threads <= 0) threads = std::max(1, (int)std::thread::hardware_concurrency());
+        workers = std::min(threads, table_count);
+        for (int t = 0; t < table_count; t++)
+        {
+            table[t].Seed(seed + (unsigned)t);
+            table[t].seated.set();
+            slot[t].sequence.store(0, std::memory_order_relaxed);
+            slot[t].wanted.store(false, std::memory_order_relaxed);
+            slot[t].rounds.store(0, std::memory_order_relaxed);
+        }
+        stop = false;
+        for (int w = 0; w < workers; w++) pool.emplace_back([this, w] { Run(w); });
+    }
+
+
+    void End()
+    {
+        stop = true;
+        for (std::thread &worker : pool) worker.join();
+        pool.clear();
+    }
+
+
+    void Run(int worker)
+    {   // round robin over this worker's tables until End()
+        trace.Name("table worker " + std::to_string(worker));
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            for (int t = worker; t < table_count; t += workers)
+            {
+                table[t].PlayHeadless();
+                sSpectatorSlot &s = slot[t];
+                long long played = s.rounds.load(std::memory_order_relaxed) + 1;
+                s.rounds.store(played, std::memory_order_relaxed);
+                if (s.wanted.load(std::memory_order_relaxed)) Publish(t, played);
+            }
+        }
+    }
+
+
+    void Publish(int t, long long played)
+    {   // worker side, the only writer of this slot
+        const sRound &round = table[t];
+        sSpectatorSlot &s = slot[t];
+        unsigned sequence = s.sequence.load(std::memory_order_relaxed);
+        s.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int seat = 0; seat < seat_count; seat++)
+        {
+            for (int i = 0; i < 5; i++) s.cards[seat * 5 + i].store(round.hands[seat].cards[i], std::memory_order_relaxed);
+            s.rank[seat].store(round.hands[seat].rank, std::memory_order_relaxed);
+            s.chips[seat].store(round.chips[seat], std::memory_order_relaxed);
+        }
+        s.winners.store((unsigned)round.winners.to_ulong(), std::memory_order_relaxed);
+        s.round.store(played, std::memory_order_relaxed);
+        s.sequence.store(sequence + 2, std::memory_order_release);
+        s.wanted.store(false, std::memory_order_relaxed);
+    }
+
+
+    void Request()
+    {   // renderer side, ask every table for its next finished round
+        for (int t = 0; t < table_count; t++) slot[t].wanted.store(true, std::memory_order_relaxed);
+    }
+
+
+    bool Read(int t, sTableSnapshot &out) const
+    {   // false when nothing is published yet or a store was in flight, out is then unspecified
+        const sSpectatorSlot &s = slot[t];
+        unsigned before = s.sequence.load(std::memory_order_acquire);
+        if (before == 0 || (before & 1)) return false;
+        for (int seat = 0; seat < seat_count; seat++)
+        {
+            for (int i = 0; i < 5; i++) out.cards[seat][i] = s.cards[seat * 5 + i].load(std::memory_order_relaxed);
+            out.rank[seat] = s.rank[seat].load(std::memory_order_relaxed);
+            out.chips[seat] = s.chips[seat].load(std::memory_order_relaxed);
+        }
+        out.winners = s.winners.load(std::memory_order_relaxed);
+        out.round = s.round.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return s.sequence.load(std::memory_order_relaxed) == before;
+    }
+
+
+    long long Rounds() const
+    {   // every table, relaxed
+        long long total = 0;
+        for (int t = 0; t < table_count; t++) total += slot[t].rounds.load(std::memory_order_relaxed);
+        return total;
+    }
+
+};
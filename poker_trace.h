@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+/*
+    Phase tracing: where a round's time goes, per thread, as a timeline.
+
+    sTraceScope marks one phase of the running thread. Each thread writes its spans into its
+    own ring of trace_ring_size, no lock and no allocation after the first span, the oldest
+    spans are overwritten once a ring is full. Off (the default) a scope costs one relaxed
+    load and a branch, no clock is read.
+
+    Write() exports every ring as Chrome trace-event JSON ("X" complete events, one tid per
+    thread, microseconds from Begin()), for chrome://tracing or ui.perfetto.dev. Spans nest
+    by time, so a round shows its Deal(), draws and Showdown() underneath it and the gaps
+    between spans are a thread waiting. Call it once the traced threads are stopped, the
+    rings are read without a lock.
+*/
+
+enum TracePhase
+{
+    trace_round, trace_intro, trace_deal, trace_rank, trace_draw, trace_dealer_draw,
+    trace_showdown, trace_payout, trace_render, trace_input, trace_idle, trace_shuffle,
+    trace_phase_count
+};
+
+static const char* const TracePhaseName[trace_phase_count] =
+{
+    "round", "intro", "Deal", "RankHand", "Draw", "DealerDraw",
+    "Showdown", "Payout", "render", "input wait", "idle", "shoe shuffle"
+};
+
+const int trace_ring_size   = 1 << 16;     // spans kept per thread, 1.5 MB
+const int max_trace_threads = 64;          // threads past this are not traced
+
+
+struct sTraceSpan
+{
+    long long begin;                       // ns from sTrace::Begin()
+    long long end;
+    int phase;
+};
+
+
+struct sTraceRing
+{
+    sTraceSpan span[trace_ring_size];
+    unsigned long long written = 0;        // spans ever recorded, owner thread only
+    int tid = 0;
+    std::string name;
+};
+
+
+struct sTrace
+{
+    typedef std::chrono::steady_clock clock;
+
+    std::atomic<bool> enabled{ false };
+    clock::time_point start;
+    std::mutex lock;                                  // registering a thread, never per span
+    std::unique_ptr<sTraceRing> ring[max_trace_threads];
+    int rings = 0;
+
+
+    void Begin()
+    {   // before any traced thread starts
+        start = clock::now();
+        enabled.store(true, std::memory_order_relaxed);
+    }
+
+
+    long long Now() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count(); }
+
+
+    sTraceRing* Mine()
+    {   // this thread's ring, made on its first span, null once every ring is taken
+        static thread_local sTraceRing* mine = nullptr;
+        static thread_local bool registered = false;
+        if (registered) return mine;
+        registered = true;
+        std::lock_guard<std::mutex> guard(lock);
+        if (rings == max_trace_threads) return nullptr;
+        ring[rings].reset(new sTraceRing());
+        mine = ring[rings].get();
+        mine->tid = ++rings;
+        mine->name = "thread " + std::to_string(mine->tid);
+        return mine;
+    }
+
+
+    void Name(const std::string &name)
+    {   // label for this thread in the viewer
+        if (!enabled.load(std::memory_order_relaxed)) return;
+        if (sTraceRing* r = Mine()) r->name = name;
+    }
+
+
+    void Record(int phase, long long begin, long long end)
+    {
+        sTraceRing* r = Mine();
+        if (!r) return;
+        sTraceSpan &s = r->span[r->written % trace_ring_size];
+        s.begin = begin;
+        s.end = end;
+        s.phase = phase;
+        r->written++;
+    }
+
+
+    bool Write(const char* path, long long &spans, long long &dropped)
+    {   // Chrome trace-event JSON of every ring, oldest span first
+        std::ofstream out(path);
+        if (!out) return false;
+        spans = dropped = 0;
+        out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        for (int i = 0; i < rings; i++)
+        {
+            const sTraceRing &r = *ring[i];
+            out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << r.tid
+                << ",\"args\":{\"name\":\"" << r.name << "\"}}";
+            first = false;
+            unsigned long long kept = std::min<unsigned long long>(r.written, trace_ring_size);
+            for (unsigned long long n = r.written - kept; n < r.written; n++)
+            {
+                const sTraceSpan &s = r.span[n % trace_ring_size];
+                out << ",\n{\"ph\":\"X\",\"name\":\"" << TracePhaseName[s.phase] << "\",\"pid\":1,\"tid\":" << r.tid
+                    << ",\"ts\":" << s.begin / 1000.0 << ",\"dur\":" << (s.end - s.begin) / 1000.0 << "}";
+            }
+            spans += (long long)kept;
+            dropped += (long long)(r.written - kept);
+        }
+        out << "\n]}\n";
+        return (bool)out;
+    }
+
+};
+
+inline sTrace trace;                       // one per process
+
+
+struct sTraceScope
+{   // one span from construction to destruction on the calling thread
+    int phase;
+    long long begin;
+
+    explicit sTraceScope(int traced) : phase(traced), begin(trace.enabled.load(std::memory_order_relaxed) ? trace.Now() : -1) {}
+    ~sTraceScope() { if (begin >= 0) trace.Record(phase, begin, trace.Now()); }
+    sTraceScope(const sTraceScope &) = delete;
+    sTraceScope &operator=(const sTraceScope &) = delete;
+};
@@ -0,0 +1,220 @@
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "poker_hand.h"
+#include "poker_batch.h"
+#include "poker_reference.h"
+#include "poker_policy.h"
+#include "poker_index.h"
+
+/*
+    Differential verifier: every one of the C(55,5) = 3,478,761 hands of the joker deck
+    is ranked by ReferenceRank() and by each production evaluator, mismatches are
+    counted by (reference rank, evaluator rank).
+
+    RankHand() runs twice, on the cards in deck order and on a scrambled order,
+    since it sorts and rotates the hand in place and must not depend on the deal order.
+
+    -shoe walks every multiset of 5 cards instead (C(59,5) = 5,006,386), the hands a
+    multi-deck shoe can deal: repeated cards, natural five of a kind, four or five jokers.
+
+    PolicyStrength<sHighPolicy> is always checked against ReferenceRank(), and its whole key
+    against HandStrength(). -policies adds the other ranking orders of poker_policy.h, each
+    against PolicyReferenceRank() of its own policy.
+
+    Without -shoe every hand also goes through HandIndex() => HandFromIndex() and
+    HandIndexes() => HandsFromIndexes(), the walk meets every index of the joker deck once.
+
+    poker_verify [-shoe] [-policies] [threads]        exit code 1 on any mismatch
+*/
+
+enum Evaluator
+{
+    eval_rankhand, eval_rankhand_scrambled, eval_rankhands, eval_high_policy,
+    eval_ace_high_policy, eval_ace_low_policy, eval_deuce_to_seven, eval_ace_to_five, eval_count
+};
+
+const int first_policy_eval = eval_ace_high_policy;         // checked with -policies only
+
+static const char* const EvaluatorName[eval_count] =
+{
+    "RankHand", "RankHand (scrambled order)", "RankHands", "sHighPolicy",
+    "sAceHighPolicy", "sAceLowPolicy", "sDeuceToSevenPolicy", "sAceToFivePolicy"
+};
+
+
+struct sTally
+{
+    long long hands = 0;
+    long long index_errors = 0;                              // HandIndex() round trips that failed
+    long long key_errors = 0;                                // sHighPolicy keys that differ from HandStrength()
+    long long mismatch[eval_count][31][31] = {};             // [evaluator][reference][got]
+    int example[eval_count][5] = {};
+    bool has_example[eval_count] = {};
+
+
+    template <class Policy>
+    void CountPolicy(int evaluator, const int cards[5])
+    {
+        Count(evaluator, PolicyReferenceRank<Policy>(cards), PolicyRank<Policy>(PolicyStrength<Policy>(cards)), cards);
+    }
+
+
+    void Count(int evaluator, int expected, int got, const int cards[5])
+    {
+        if (expected == got) return;
+        mismatch[evaluator][expected][got]++;
+        if (has_example[evaluator]) return;
+        has_example[evaluator] = true;
+        for (int i = 0; i < 5; i++) example[evaluator][i] = cards[i];
+    }
+};
+
+
+int main(int argc, char* argv[])
+{
+    int arg = 1;
+    bool shoe = false;
+    bool policies = false;
+    for (; arg < argc && argv[arg][0] == '-'; arg++)
+    {
+        if (std::strcmp(argv[arg], "-shoe") == 0) shoe = true;
+        if (std::strcmp(argv[arg], "-policies") == 0) policies = true;
+    }
+    int threads = (argc > arg) ? std::atoi(argv[arg]) : (int)std::thread::hardware_concurrency();
+    if (threads < 1) threads = 1;
+    const int step = shoe ? 0 : 1;                           // next card starts at the same id (shoe) or the one after
+
+    // work items are the first two cards, about 1500 of them keeps the threads evenly loaded
+    std::vector<std::pair<int, int>> items;
+    for (int a = 1; a <= deck_size; a++)
+        for (int b = a + step; b <= deck_size; b++) items.push_back({ a, b });
+    std::atomic<size_t> next_item{ 0 };
+    std::vector<sTally> tally(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++)
+    {
+        pool.emplace_back([&, t]
+        {
+            sTally &mine = tally[t];
+            std::vector<int> cards;
+            std::vector<int> expected;
+            std::vector<int> batch_rank;
+            std::vector<unsigned> batch_index;
+            std::vector<int> batch_cards;
+            for (size_t item; (item = next_item++) < items.size();)
+            {
+                int a = items[item].first;
+                int b = items[item].second;
+                cards.clear();
+                expected.clear();
+                for (int c = b + step; c <= deck_size; c++)
+                    for (int d = c + step; d <= deck_size; d++)
+                        for (int e = d + step; e <= deck_size; e++)
+                        {
+                            const int hand[5] = { a, b, c, d, e };
+                            cards.insert(cards.end(), hand, hand + 5);
+                            int ref = ReferenceRank(hand);
+                            expected.push_back(ref);
+
+                            HandInfo info = { { a, b, c, d, e } };
+                            RankHand(info);
+                            mine.Count(eval_rankhand, ref, info.rank, hand);
+
+                            HandInfo scrambled = { { e, b, d, a, c } };
+                            RankHand(scrambled);
+                            mine.Count(eval_rankhand_scrambled, ref, scrambled.rank, hand);
+
+                            if (!shoe)
+                            {
+                                int back[5];
+                                unsigned index = HandIndex(scrambled.cards);
+                                HandFromIndex(index, 5, back);
+                                if (index >= HandCount(deck_size, 5) || !std::equal(back, back + 5, hand)) mine.index_errors++;
+                            }
+
+                            unsigned high_key = PolicyStrength<sHighPolicy>(hand);
+                            mine.Count(eval_high_policy, ref, PolicyRank<sHighPolicy>(high_key), hand);
+                            if (high_key != HandStrength(info)) mine.key_errors++;
+                            if (!policies) continue;
+                            mine.CountPolicy<sAceHighPolicy>(eval_ace_high_policy, hand);
+                            mine.CountPolicy<sAceLowPolicy>(eval_ace_low_policy, hand);
+                            mine.CountPolicy<sDeuceToSevenPolicy>(eval_deuce_to_seven, hand);
+                            mine.CountPolicy<sAceToFivePolicy>(eval_ace_to_five, hand);
+                        }
+
+                int n = (int)expected.size();
+                batch_rank.resize(n);
+                RankHands((const int(*)[5])cards.data(), n, batch_rank.data());
+                for (int i = 0; i < n; i++)
+                    mine.Count(eval_rankhands, expected[i], batch_rank[i], &cards[i * 5]);
+                if (!shoe)
+                {
+                    batch_index.resize(n);
+                    HandIndexes((const int(*)[5])cards.data(), n, batch_index.data());
+                    for (int i = 0; i < n; i++)
+                        if (batch_index[i] != HandIndex(&cards[i * 5], 5)) mine.index_errors++;
+                    batch_cards.resize(cards.size());
+                    HandsFromIndexes(batch_index.data(), n, (int(*)[5])batch_cards.data());
+                    for (int i = 0; i < n; i++)
+                        if (!std::equal(&cards[i * 5], &cards[i * 5] + 5, &batch_cards[i * 5])) mine.index_errors++;
+                }
+                mine.hands += n;
+            }
+        });
+    }
+    for (std::thread &worker : pool) worker.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    sTally total;
+    for (const sTally &t : tally)
+    {
+        total.hands += t.hands;
+        total.index_errors += t.index_errors;
+        total.key_errors += t.key_errors;
+        for (int v = 0; v < eval_count; v++)
+        {
+            for (int r = 0; r < 31; r++)
+                for (int g = 0; g < 31; g++) total.mismatch[v][r][g] += t.mismatch[v][r][g];
+            if (t.has_example[v] && !total.has_example[v])
+            {
+                total.has_example[v] = true;
+                for (int i = 0; i < 5; i++) total.example[v][i] = t.example[v][i];
+            }
+        }
+    }
+
+    std::cout << total.hands << " hands, " << threads << " threads, " << seconds << "s\n";
+    long long failures = total.index_errors + total.key_errors;
+    if (!shoe) std::cout << "\nHandIndex round trip: " << total.index_errors << " mismatches\n";
+    std::cout << "\nsHighPolicy key vs HandStrength(): " << total.key_errors << " mismatches\n";
+    for (int v = 0; v < eval_count; v++)
+    {
+        if (v >= first_policy_eval && !policies) continue;
+        long long count = 0;
+        for (int r = 0; r < 31; r++)
+            for (int g = 0; g < 31; g++) count += total.mismatch[v][r][g];
+        failures += count;
+        std::cout << "\n" << EvaluatorName[v] << ": " << count << " mismatches\n";
+        for (int r = 0; r < 31; r++)
+            for (int g = 0; g < 31; g++)
+                if (total.mismatch[v][r][g])
+                    std::cout << "  " << PokerHandName[r] << " => " << PokerHandName[g] << ": " << total.mismatch[v][r][g] << "\n";
+        if (total.has_example[v])
+        {
+            std::cout << "  e.g. cards";
+            for (int card : total.example[v]) std::cout << " " << card;
+            std::cout << "\n";
+        }
+    }
+    return failures ? 1 : 0;
+}